@@ -0,0 +1,183 @@
+#include <json/json.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "logging.h"
+
+/// Tolerated change of one metric: a regression must exceed both the
+/// relative and the absolute threshold.
+struct Tolerance {
+  double ratio = 0.1;
+  double delta = 0;
+};
+
+/// Per-metric overrides, keyed by the metric (leaf) name.  A leading '*'
+/// matches by suffix, e.g. "*_ms".
+using ToleranceRules = std::vector<std::pair<std::string, Tolerance>>;
+
+static bool matchMetric(const std::string &pattern, const std::string &name) {
+  if (!pattern.empty() && pattern[0] == '*') {
+    auto suffix = pattern.substr(1);
+    return name.size() >= suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) ==
+               0;
+  }
+  return pattern == name;
+}
+
+/// Metrics where a larger value is better; everything else (time, memory,
+/// IR size) is a cost.  'reuse_registers' counts the loads kept in registers.
+static bool higherIsBetter(const std::string &name) {
+  return name.find("throughput") != std::string::npos ||
+         name == "reuse_registers" ||
+         matchMetric("*_per_s", name) || matchMetric("*_gbps", name);
+}
+
+/// Flattens all numeric leaves to "path/to/metric" -> value.  Array elements
+/// carrying a "name" are keyed by it so that reordering does not matter.
+static void flatten(const Json::Value &value, const std::string &prefix,
+                    std::map<std::string, double> *metrics) {
+  if (value.isObject()) {
+    for (auto &key : value.getMemberNames())
+      flatten(value[key], prefix.empty() ? key : prefix + "/" + key, metrics);
+  } else if (value.isArray()) {
+    for (Json::ArrayIndex i = 0; i < value.size(); ++i) {
+      auto &elem = value[i];
+      std::string key = elem.isObject() && elem["name"].isString()
+                            ? elem["name"].asString()
+                            : std::to_string(i);
+      flatten(elem, prefix.empty() ? key : prefix + "/" + key, metrics);
+    }
+  } else if (value.isNumeric() && !value.isBool()) {
+    (*metrics)[prefix] = value.asDouble();
+  }
+}
+
+static std::map<std::string, double> readMetrics(const std::string &path) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  if (!in.is_open()) ELENA_ABORT("cannot open " << path);
+  Json::Value root;
+  Json::CharReaderBuilder builder;
+  std::string errors;
+  if (!Json::parseFromStream(builder, in, &root, &errors))
+    ELENA_ABORT("cannot parse " << path << ": " << errors);
+  std::map<std::string, double> metrics;
+  flatten(root, "", &metrics);
+  return metrics;
+}
+
+static std::string leafName(const std::string &path) {
+  auto pos = path.rfind('/');
+  return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+/// Parses "<ratio>" or "<metric>:<ratio>" into the rules.
+static void parseRule(const std::string &arg, bool is_ratio,
+                      Tolerance *global, ToleranceRules *rules) {
+  auto pos = arg.rfind(':');
+  double v = std::stod(pos == std::string::npos ? arg : arg.substr(pos + 1));
+  if (pos == std::string::npos) {
+    (is_ratio ? global->ratio : global->delta) = v;
+    return;
+  }
+  auto metric = arg.substr(0, pos);
+  for (auto &rule : *rules) {
+    if (rule.first == metric) {
+      (is_ratio ? rule.second.ratio : rule.second.delta) = v;
+      return;
+    }
+  }
+  Tolerance tol = *global;
+  (is_ratio ? tol.ratio : tol.delta) = v;
+  rules->emplace_back(metric, tol);
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> files;
+  std::vector<std::string> ignored;
+  Tolerance global;
+  // Overrides are collected first so that the global values given later on
+  // the command line still act as their defaults.
+  std::vector<std::pair<std::string, bool>> rule_args;
+  bool usage_error = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.compare(0, 12, "--threshold=") == 0) {
+      rule_args.emplace_back(arg.substr(12), true);
+    } else if (arg.compare(0, 12, "--min-delta=") == 0) {
+      rule_args.emplace_back(arg.substr(12), false);
+    } else if (arg.compare(0, 9, "--ignore=") == 0) {
+      ignored.push_back(arg.substr(9));
+    } else if (arg.compare(0, 2, "--") == 0) {
+      usage_error = true;
+    } else {
+      files.push_back(arg);
+    }
+  }
+  if (usage_error || files.size() != 2) {
+    std::cerr << "usage: elena_bench_compare <baseline.json> <result.json> "
+                 "[--threshold=[<metric>:]<ratio>] "
+                 "[--min-delta=[<metric>:]<abs>] [--ignore=<metric>]\n"
+                 "  <metric> is a leaf name, a leading '*' matches a suffix."
+              << std::endl;
+    return 2;
+  }
+  ToleranceRules rules;
+  for (auto &r : rule_args)
+    if (r.first.find(':') == std::string::npos)
+      parseRule(r.first, r.second, &global, &rules);
+  for (auto &r : rule_args)
+    if (r.first.find(':') != std::string::npos)
+      parseRule(r.first, r.second, &global, &rules);
+
+  auto baseline = readMetrics(files[0]);
+  auto result = readMetrics(files[1]);
+
+  int regressions = 0, improvements = 0, missing = 0, compared = 0;
+  for (auto &kv : baseline) {
+    auto leaf = leafName(kv.first);
+    bool skip = false;
+    for (auto &pattern : ignored) skip |= matchMetric(pattern, leaf);
+    if (skip) continue;
+
+    auto iter = result.find(kv.first);
+    if (iter == result.end()) {
+      std::cout << "MISSING     " << kv.first << std::endl;
+      ++missing;
+      continue;
+    }
+    ++compared;
+
+    Tolerance tol = global;
+    for (auto &rule : rules)
+      if (matchMetric(rule.first, leaf)) tol = rule.second;
+
+    double base = kv.second, cur = iter->second;
+    double worse = higherIsBetter(leaf) ? base - cur : cur - base;
+    double limit = std::max(std::fabs(base) * tol.ratio, tol.delta);
+    if (std::fabs(worse) <= limit) continue;
+
+    bool regressed = worse > 0;
+    regressed ? ++regressions : ++improvements;
+    char line[64];
+    snprintf(line, sizeof(line), "%14.4f -> %14.4f (%+7.1f%%)  ", base, cur,
+             base != 0 ? 100.0 * (cur - base) / std::fabs(base) : 0.0);
+    std::cout << (regressed ? "REGRESSION  " : "improvement ") << line
+              << kv.first << std::endl;
+  }
+  for (auto &kv : result)
+    if (!baseline.count(kv.first))
+      std::cout << "NEW         " << kv.first << std::endl;
+
+  std::cout << compared << " metrics compared, " << regressions
+            << " regressions, " << improvements << " improvements, "
+            << missing << " missing" << std::endl;
+  return regressions || missing ? 1 : 0;
+}
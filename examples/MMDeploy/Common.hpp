@@ -7,7 +7,7 @@ using namespace ir;
 enum Target { CPU = 1, CUDA = 2 };
 enum Dtype { Uint8 = 1, Int32 = 2, Float32 = 3 };
 enum Format { BGR = 1, RGB = 2, GRAY = 3, BGRA = 4, NV12 = 5, NV21 = 6 };
-enum Interpolation { Bilinear = 1, Nearest = 2 };
+enum Interpolation { Bilinear = 1, Nearest = 2, Area = 3, Bicubic = 4, Pil = 5 };
 
 namespace Common {
 std::vector<std::vector<float>> NV2BGR_params{
@@ -69,6 +69,21 @@ ir::TensorVarPtr CastFloat(const std::vector<ir::ExprPtr> &shape,
                       "CastFloat");
 }
 
+/// Rounds the float output to Float16 or BFloat16, the last fused step of
+/// kernels writing half precision.
+ir::TensorVarPtr CastHalf(const std::vector<ir::ExprPtr> &shape,
+                          ir::Array<ir::IterVar> iter_vars,
+                          ir::TensorVarPtr input, ir::ScalarType dtype,
+                          const std::string &name = "CastHalf") {
+  ELENA_ASSERT(dtype == ir::ScalarType::Float16 ||
+                   dtype == ir::ScalarType::BFloat16,
+               "CastHalf casts to Float16 or BFloat16 only");
+
+  return api::compute(
+      shape, iter_vars,
+      cast((*input)(iter_vars[0], iter_vars[1], iter_vars[2]), dtype), name);
+}
+
 ir::TensorVarPtr BGRMean(std::vector<float> &mean,
                          const std::string &name = "BGRMean") {
   ELENA_ASSERT(mean.size() == 3, "BGRMean");
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Fuse.hpp"
+
+/// Op lists of growing length, all starting from a BGR conversion so that
+/// every input format produces a kernel.
+static const std::vector<std::vector<std::string>> BenchOpLists{
+    {"cvtColorBGR", "CastFloat"},
+    {"cvtColorBGR", "CastFloat", "Normalize"},
+    {"cvtColorBGR", "Resize", "CastFloat", "Normalize"},
+    {"cvtColorBGR", "Resize", "CenterCrop", "CastFloat", "Normalize"},
+    {"cvtColorBGR", "Resize", "CenterCrop", "CastFloat", "Normalize", "Pad",
+     "HWC2CHW"},
+    {"cvtColorBGR", "Resize", "CenterCrop", "CastFloat", "cvtColorRGB",
+     "Normalize", "Pad", "HWC2CHW"},
+    {"cvtColorBGR", "Resize", "CenterCrop", "CastFloat", "cvtColorRGB",
+     "Normalize", "Pad", "CenterCrop", "Normalize", "HWC2CHW"},
+    {"cvtColorBGR", "Resize", "CenterCrop", "CastFloat", "cvtColorRGB",
+     "Normalize", "Pad", "Resize", "CenterCrop", "Normalize", "Pad",
+     "HWC2CHW"},
+};
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+/// Number of registers 'replaceScalars' declared in a generated kernel, one
+/// 'reuse<N>[1];' declaration each.
+static uint64_t countReuseRegisters(const std::string &code) {
+  uint64_t count = 0;
+  for (size_t pos = code.find(" reuse"); pos != std::string::npos;
+       pos = code.find(" reuse", pos + 1)) {
+    size_t end = pos + 6;
+    while (end < code.size() && isdigit(code[end])) ++end;
+    if (end > pos + 6 && code.compare(end, 4, "[1];") == 0) ++count;
+  }
+  return count;
+}
+
+/// Compiles every kernel OpFuse would generate for OpList once.
+static Json::Value runCase(const std::vector<std::string> &OpList,
+                           const std::string &pipeline) {
+  bool ResizeOp =
+      std::find(OpList.begin(), OpList.end(), "Resize") != OpList.end();
+  bool ResizeFloat = false;
+
+  // A fresh manager per case, so its statistics only cover this case.
+  PassManager pass_manager;
+  pass_manager.setPipeline(pipeline);
+  pass_manager.enableStatistics(true);
+
+  Json::Value kernels(Json::arrayValue);
+  double total_ms = 0;
+  for (int cur_format = 1; cur_format <= 6; cur_format++) {
+    for (int interpolation = 1; interpolation <= (ResizeOp ? 2 : 1);
+         interpolation++) {
+      Format format = (Format)cur_format;
+      Interpolation ResizeInterpolation =
+          ResizeOp ? (Interpolation)interpolation : Nearest;
+
+      size_t first_stat = pass_manager.getStatistics().size();
+      Fuse::KernelTiming timing;
+      std::string code =
+          Fuse::GenerateKernel(OpList, BGR, format, ResizeInterpolation, CPU,
+                               pass_manager, ResizeFloat, &timing);
+
+      // Node counting happens between passes, keep it out of the timings.
+      double lower_ms = 0;
+      uint64_t max_nodes = 0, nodes = 0;
+      const auto &stats = pass_manager.getStatistics();
+      for (size_t i = first_stat; i < stats.size(); ++i) {
+        lower_ms += stats[i].wall_ms;
+        max_nodes = std::max(max_nodes, std::max(stats[i].nodes_before,
+                                                 stats[i].nodes_after));
+        nodes = stats[i].nodes_after;
+      }
+
+      Json::Value kernel;
+      kernel["name"] = Fuse::KernelName(format, ResizeInterpolation);
+      kernel["compile_ms"] = timing.build_ms + lower_ms + timing.codegen_ms;
+      kernel["build_ms"] = timing.build_ms;
+      kernel["lower_ms"] = lower_ms;
+      kernel["codegen_ms"] = timing.codegen_ms;
+      kernel["nodes"] = Json::UInt64(nodes);
+      kernel["max_nodes"] = Json::UInt64(max_nodes);
+      kernel["reuse_registers"] = Json::UInt64(countReuseRegisters(code));
+      kernels.append(kernel);
+      total_ms += kernel["compile_ms"].asDouble();
+    }
+  }
+
+  Json::Value result;
+  Json::Value ops(Json::arrayValue);
+  for (auto &op : OpList) ops.append(op);
+  result["ops"] = ops;
+  result["total_ms"] = total_ms;
+  result["kernels"] = kernels;
+  return result;
+}
+
+int main(int argc, char *argv[]) {
+  std::string output;
+  std::string pipeline = PassManager::defaultPipeline();
+  int repeat = 5;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.compare(0, 9, "--output=") == 0) {
+      output = arg.substr(9);
+    } else if (arg.compare(0, 9, "--passes=") == 0) {
+      pipeline = arg.substr(9);
+    } else if (arg.compare(0, 9, "--repeat=") == 0) {
+      repeat = std::max(1, std::stoi(arg.substr(9)));
+    } else {
+      ELENA_ABORT("usage: elena_compile_bench [--output=<json>] "
+                  "[--repeat=N] [--passes=<p1,p2,...>]");
+    }
+  }
+
+  auto bench_start = std::chrono::steady_clock::now();
+  // Warm up allocator and caches, otherwise the first case looks slow.
+  runCase(BenchOpLists.back(), pipeline);
+
+  Json::Value cases(Json::arrayValue);
+  for (auto &OpList : BenchOpLists) {
+    // Keep the fastest repetition, the others only add scheduling noise.
+    Json::Value best;
+    for (int r = 0; r < repeat; ++r) {
+      Json::Value result = runCase(OpList, pipeline);
+      if (best.isNull() ||
+          result["total_ms"].asDouble() < best["total_ms"].asDouble())
+        best = result;
+    }
+    char name[16];
+    snprintf(name, sizeof(name), "ops_%02zu", OpList.size());
+    best["name"] = name;
+    // ru_maxrss never decreases, so this is the peak over all cases so far.
+    best["peak_rss_kb"] = Json::Int64(api::peakMemoryKB());
+    cases.append(best);
+
+    std::cerr << name << ": " << best["kernels"].size() << " kernels, "
+              << best["total_ms"].asDouble() << " ms" << std::endl;
+  }
+
+  Json::Value root;
+  root["benchmark"] = "elena_compile_bench";
+  root["target"] = "cpu";
+  root["pipeline"] = pipeline;
+  root["repeat"] = repeat;
+  double total_ms = 0;
+  for (auto &c : cases) total_ms += c["total_ms"].asDouble();
+  root["total_ms"] = total_ms;
+  root["wall_ms"] = msSince(bench_start);
+  root["peak_rss_kb"] = Json::Int64(api::peakMemoryKB());
+  root["cases"] = cases;
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "  ";
+  builder["precision"] = 4;
+  builder["precisionType"] = "decimal";
+  std::string json = Json::writeString(builder, root) + "\n";
+  if (output.empty()) {
+    std::cout << json;
+  } else {
+    std::ofstream out(output);
+    if (!out.is_open()) ELENA_ABORT("cannot open " << output);
+    out << json;
+  }
+  return 0;
+}
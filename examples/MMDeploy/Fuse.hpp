@@ -0,0 +1,639 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Crop.hpp"
+#include "CvtColor.hpp"
+#include "Json.hpp"
+#include "LayoutTrans.hpp"
+#include "Norm.hpp"
+#include "Pad.hpp"
+#include "Pass/Common/PassManager.h"
+#include "Remap.hpp"
+#include "Resize.hpp"
+#include "Warp.hpp"
+
+#define BLOCK_SIZE 32  // for cuda device
+// largest supported image, crop or pad dimension (and offset).
+#define MAX_IMAGE_SIZE 16384
+
+namespace Fuse {
+
+/// Time spent outside the PassManager while generating one kernel; the
+/// lowering itself is reported by the PassManager statistics.
+struct KernelTiming {
+  double build_ms = 0;    // OpList to scheduled IR
+  double codegen_ms = 0;  // lowered stmt to source code
+};
+
+/// Name of the generated kernel, e.g. "BGR_Bilinear_Kernel".
+std::string KernelName(Format format, Interpolation ResizeInterpolation) {
+  std::string kernel_name;
+  if (format == BGR)
+    kernel_name += "BGR_";
+  else if (format == GRAY)
+    kernel_name += "GRAY_";
+  else if (format == RGB)
+    kernel_name += "RGB_";
+  else if (format == BGRA)
+    kernel_name += "BGRA_";
+  else if (format == NV12)
+    kernel_name += "NV12_";
+  else if (format == NV21)
+    kernel_name += "NV21_";
+
+  if (ResizeInterpolation == Nearest)
+    kernel_name += "Nearest_";
+  else if (ResizeInterpolation == Bilinear)
+    kernel_name += "Bilinear_";
+  else if (ResizeInterpolation == Area)
+    kernel_name += "Area_";
+  else if (ResizeInterpolation == Bicubic)
+    kernel_name += "Bicubic_";
+  else if (ResizeInterpolation == Pil)
+    kernel_name += "Pil_";
+
+  kernel_name += "Kernel";
+  return kernel_name;
+}
+
+/**
+ * @brief Generate the fused kernel of OpList for one input format and
+ * interpolation.
+ * @param ResizeFloat set when the cpu runtime shall use the float bilinear
+ * preprocess.
+ * @param timing optional, filled with the build and codegen wall time.
+ * @param UnrollFactor unroll the column loop of cpu kernels by this factor,
+ * 0 to keep it.
+ * @param OutputType Float32, or Float16 / BFloat16 (cpu only) to round the
+ * output to half precision in the same loop.
+ * @return the generated source code of the kernel.
+ */
+std::string GenerateKernel(const std::vector<std::string> &OpList,
+                           Format CvtFormat, Format format,
+                           Interpolation ResizeInterpolation, Target target,
+                           PassManager &pass_manager, bool &ResizeFloat,
+                           KernelTiming *timing = nullptr,
+                           uint64_t UnrollFactor = 0,
+                           ir::ScalarType OutputType =
+                               ir::ScalarType::Float32) {
+  Dtype dtype = Uint8;  // also support float32
+
+  auto build_start = std::chrono::steady_clock::now();
+
+  /* 2.1 Initialization */
+  auto h = std::make_shared<ir::ScalarVar>("h", ir::ScalarType::UInt64);
+  auto w = std::make_shared<ir::ScalarVar>("w", ir::ScalarType::UInt64);
+  ir::ExprPtr c;
+  ir::TensorVarPtr img;
+  Common::GenerateChannelAndInput(format, dtype, h, w, c, img);
+
+  /* 2.2 OpList to IR Stage */
+  auto intermediate = img;
+
+  std::vector<ir::TensorVarPtr> stage_list;
+  ir::Array<ir::IterVar> iter_vars;
+  std::vector<ir::ExprPtr> arg_list;
+
+  // pin the arglist
+  auto resize_h =
+      std::make_shared<ir::ScalarVar>("resize_h", ir::ScalarType::UInt64);
+  auto resize_w =
+      std::make_shared<ir::ScalarVar>("resize_w", ir::ScalarType::UInt64);
+  auto crop_h =
+      std::make_shared<ir::ScalarVar>("crop_h", ir::ScalarType::UInt64);
+  auto crop_w =
+      std::make_shared<ir::ScalarVar>("crop_w", ir::ScalarType::UInt64);
+  auto crop_top =
+      std::make_shared<ir::ScalarVar>("crop_top", ir::ScalarType::Int32);
+  auto crop_left =
+      std::make_shared<ir::ScalarVar>("crop_left", ir::ScalarType::Int32);
+  auto norm_mean_0 = std::make_shared<ir::ScalarVar>(
+      "norm_mean_0", ir::ScalarType::Float32);
+  auto norm_mean_1 = std::make_shared<ir::ScalarVar>(
+      "norm_mean_1", ir::ScalarType::Float32);
+  auto norm_mean_2 = std::make_shared<ir::ScalarVar>(
+      "norm_mean_2", ir::ScalarType::Float32);
+  auto norm_std_0 = std::make_shared<ir::ScalarVar>(
+      "norm_std_0", ir::ScalarType::Float32);
+  auto norm_std_1 = std::make_shared<ir::ScalarVar>(
+      "norm_std_1", ir::ScalarType::Float32);
+  auto norm_std_2 = std::make_shared<ir::ScalarVar>(
+      "norm_std_2", ir::ScalarType::Float32);
+  auto pad_h =
+      std::make_shared<ir::ScalarVar>("pad_h", ir::ScalarType::UInt64);
+  auto pad_w =
+      std::make_shared<ir::ScalarVar>("pad_w", ir::ScalarType::UInt64);
+  auto pad_top =
+      std::make_shared<ir::ScalarVar>("pad_top", ir::ScalarType::Int32);
+  auto pad_left =
+      std::make_shared<ir::ScalarVar>("pad_left", ir::ScalarType::Int32);
+  auto pad_bottom =
+      std::make_shared<ir::ScalarVar>("pad_bottom", ir::ScalarType::Int32);
+  auto pad_right =
+      std::make_shared<ir::ScalarVar>("pad_right", ir::ScalarType::Int32);
+  auto pad_value =
+      std::make_shared<ir::ScalarVar>("pad_value", ir::ScalarType::Float32);
+
+  arg_list.push_back(resize_h);
+  arg_list.push_back(resize_w);
+  arg_list.push_back(crop_h);
+  arg_list.push_back(crop_w);
+  arg_list.push_back(crop_top);
+  arg_list.push_back(crop_left);
+  arg_list.push_back(norm_mean_0);
+  arg_list.push_back(norm_mean_1);
+  arg_list.push_back(norm_mean_2);
+  arg_list.push_back(norm_std_0);
+  arg_list.push_back(norm_std_1);
+  arg_list.push_back(norm_std_2);
+  arg_list.push_back(pad_h);
+  arg_list.push_back(pad_w);
+  arg_list.push_back(pad_top);
+  arg_list.push_back(pad_left);
+  arg_list.push_back(pad_bottom);
+  arg_list.push_back(pad_right);
+  arg_list.push_back(pad_value);
+
+  auto two = api::constant<uint64_t>(2);
+  // for uint8_t
+  auto cubh = api::placeholder<int16_t>({two, resize_h}, "cubh");
+  auto cubw = api::placeholder<int16_t>({two, resize_w}, "cubw");
+  // for float32
+  auto cubfh = api::placeholder<float>({two, resize_h}, "cubfh");
+  auto cubfw = api::placeholder<float>({two, resize_w}, "cubfw");
+  auto nearh = api::placeholder<int32_t>({resize_h}, "nearh");
+  auto nearw = api::placeholder<int32_t>({resize_w}, "nearw");
+  auto inth = api::placeholder<int32_t>({two, resize_h}, "inth");
+  auto intw = api::placeholder<int32_t>({two, resize_w}, "intw");
+  // for the uint8 Bilinear, the distinct source rows of inth and the row of
+  // each tap among them
+  auto row_n = std::make_shared<ir::ScalarVar>("row_n", ir::ScalarType::UInt64);
+  auto rowh = api::placeholder<int32_t>({row_n}, "rowh");
+  auto sloth = api::placeholder<int32_t>({two, resize_h}, "sloth");
+  // for Area, the number of weights per output row and column
+  auto area_kh =
+      std::make_shared<ir::ScalarVar>("area_kh", ir::ScalarType::UInt64);
+  auto area_kw =
+      std::make_shared<ir::ScalarVar>("area_kw", ir::ScalarType::UInt64);
+  auto areah = api::placeholder<int32_t>({two, resize_h}, "areah");
+  auto areaw = api::placeholder<int32_t>({two, resize_w}, "areaw");
+  // for Bicubic, the 4 taps of each output row and column
+  auto four = api::constant<uint64_t>(4);
+  auto cubich = api::placeholder<int32_t>({four, resize_h}, "cubich");
+  auto cubicw = api::placeholder<int32_t>({four, resize_w}, "cubicw");
+  // for Pil, the number of weights per output row and column
+  auto pil_kh =
+      std::make_shared<ir::ScalarVar>("pil_kh", ir::ScalarType::UInt64);
+  auto pil_kw =
+      std::make_shared<ir::ScalarVar>("pil_kw", ir::ScalarType::UInt64);
+  auto pilh = api::placeholder<int32_t>({two, resize_h}, "pilh");
+  auto pilw = api::placeholder<int32_t>({two, resize_w}, "pilw");
+  // for WarpAffine, the source coordinates depending on the output row and
+  // on the output column
+  auto warph = api::placeholder<float>({two, resize_h}, "warph");
+  auto warpw = api::placeholder<float>({two, resize_w}, "warpw");
+
+  /* common expression extraction */
+  ir::TensorVarPtr scale_value;
+  ir::TensorVarPtr bias_value;
+  ir::TensorVarPtr nv2bgr_params = Common::NV2BGRParams();
+
+  // Normalize runs as 'x * scale[c] + bias[c]', scale and bias are computed
+  // once per call from the mean and std arguments.
+  if (std::find(OpList.begin(), OpList.end(), "Normalize") !=
+      OpList.end()) {
+    std::vector<ir::ExprPtr> mean_vec{norm_mean_0, norm_mean_1,
+                                      norm_mean_2};
+    std::vector<ir::ExprPtr> std_vec{norm_std_0, norm_std_1, norm_std_2};
+    if (CvtFormat != BGR) {
+      mean_vec.resize(1);
+      std_vec.resize(1);
+    }
+    scale_value = Norm::Scale(std_vec);
+    bias_value = Norm::Bias(mean_vec, std_vec);
+  }
+  // The last Pad (or Letterbox) and its input, a directly following
+  // Normalize is moved in front of it.
+  ir::TensorVarPtr pad_stage, pad_input;
+  // The horizontal pass of a bilinear, area or pil resize, a buffer of the
+  // caller.
+  ir::TensorVarPtr resize_row;
+  // GRAY2BGR replicates the gray channel, the resize of its output need only
+  // compute one.
+  ir::TensorVarPtr gray_stage;
+  bool letterbox = false;
+  // set after a rotation by 90 or 270 degrees, the image is then w x h.
+  bool transposed = false;
+
+  // Flip and Rotate commute with the colour conversion, which is per pixel,
+  // so the ones directly in front of it are moved after it, where NV12 and
+  // NV21 have become pixels.  An earlier remap would have to cross the ops
+  // in between as well, which need not commute with it.
+  auto is_remap = [](const std::string &op) {
+    return op.compare(0, 4, "Flip") == 0 || op.compare(0, 6, "Rotate") == 0;
+  };
+  std::vector<std::string> ops = OpList;
+  auto cvt = std::find_if(ops.begin(), ops.end(), [](const std::string &op) {
+    return op == "cvtColorBGR" || op == "cvtColorGRAY";
+  });
+  if (cvt != ops.end()) {
+    auto first = cvt;
+    while (first != ops.begin() && is_remap(*(first - 1))) --first;
+    if (std::any_of(ops.begin(), first, is_remap)) {
+      ELENA_ABORT("Flip and Rotate before the colour conversion must directly "
+                  "precede it");
+    }
+    std::rotate(first, cvt, cvt + 1);
+  }
+  // The half precision output is rounded last, before a final HWC2CHW so that
+  // the transposed store keeps its loop order.
+  if (OutputType != ir::ScalarType::Float32) {
+    ELENA_ASSERT(target == CPU,
+                 "half precision output is only supported on cpu");
+    auto last = !ops.empty() && ops.back() == "HWC2CHW" ? ops.end() - 1
+                                                        : ops.end();
+    ops.insert(last, "CastHalf");
+  }
+
+  for (auto &op : ops) {
+    ir::TensorVarPtr cur_stage;
+    if (op == "cvtColorBGR" || op == "cvtColorGRAY") {
+      if (CvtFormat == BGR) {
+        std::vector<ir::ExprPtr> color_shape{h, w,
+                                             api::constant<uint64_t>(3)};
+        if (format == BGR) {
+          continue;
+        } else if (format == RGB) {
+          cur_stage = CvtColor::RGB2BGR(color_shape, intermediate);
+        } else if (format == GRAY) {
+          cur_stage = CvtColor::GRAY2BGR(color_shape, intermediate);
+          gray_stage = cur_stage;
+        } else if (format == BGRA) {
+          cur_stage = CvtColor::BGRA2BGR(color_shape, intermediate);
+        } else if (format == NV12) {
+          cur_stage =
+              CvtColor::NV122BGR(color_shape, intermediate, nv2bgr_params);
+        } else if (format == NV21) {
+          cur_stage =
+              CvtColor::NV212BGR(color_shape, intermediate, nv2bgr_params);
+        } else {
+          ELENA_ABORT(
+              "not support temporarily in CvtColr when CvtFormat == BGR");
+        }
+      } else if (CvtFormat == GRAY) {
+        std::vector<ir::ExprPtr> color_shape{h, w,
+                                             api::constant<uint64_t>(1)};
+        if (format == BGR) {
+          cur_stage = CvtColor::BGR2GRAY(color_shape, intermediate);
+        } else if (format == RGB) {
+          cur_stage = CvtColor::RGB2GRAY(color_shape, intermediate);
+        } else if (format == GRAY) {
+          continue;
+        } else if (format == BGRA) {
+          cur_stage = CvtColor::BGRA2GRAY(color_shape, intermediate);
+        } else if (format == NV12) {
+          cur_stage = CvtColor::NV122GRAY(color_shape, intermediate);
+        } else if (format == NV21) {
+          cur_stage = CvtColor::NV212GRAY(color_shape, intermediate);
+        } else {
+          ELENA_ABORT(
+              "not support temporarily in CvtColr when CvtFormat == GRAY");
+        }
+      } else {
+        ELENA_ABORT("not support temporarily in CvtColr");
+      }
+    } else if (op == "Resize" || op == "Letterbox" ||
+               op == "CropResizeBatch") {
+      // CropResizeBatch resizes one box per kernel call, through tables
+      // offset to the box within the whole frame.  The tables are computed
+      // from src_h x src_w at runtime, which a transposed image is not.
+      ELENA_ASSERT(!transposed,
+                   "Rotate by 90 or 270 degrees must follow the resize");
+      std::vector<ir::ExprPtr> resize_shape{
+          resize_h, resize_w, intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(resize_shape);
+      if (ResizeInterpolation == Nearest) {
+        if (target == CUDA) {
+          cur_stage = Resize::Nearest(resize_shape, iter_vars, intermediate);
+        } else {
+          arg_list.push_back(nearh);
+          arg_list.push_back(nearw);
+          cur_stage = Resize::NearestTable(resize_shape, iter_vars,
+                                           intermediate, nearh, nearw);
+        }
+      } else if (ResizeInterpolation == Bilinear) {
+        /* aim to uint8 condition */
+        if (intermediate->get_dtype() == ir::ScalarType::Float32) {
+          if(target == CUDA) {
+            cur_stage = Resize::BilinearFloatCUDA(resize_shape, iter_vars, intermediate, h, w);
+          } else {
+            arg_list.push_back(inth);
+            arg_list.push_back(intw);
+            arg_list.push_back(cubfh);
+            arg_list.push_back(cubfw);
+            cur_stage =
+                Resize::BilinearFloat(resize_shape, iter_vars, intermediate,
+                                      cubfh, cubfw, inth, intw);
+          }  
+          if (format <= BGRA)
+            ResizeFloat = true;  // NV12 & NV21 is float dtype
+        } else if (intermediate->get_dtype() == ir::ScalarType::UInt8) {
+          if(target == CUDA) {
+            cur_stage = Resize::BilinearCUDA(resize_shape, iter_vars, intermediate, h, w);
+          }
+          else {
+            ELENA_ASSERT(!resize_row, "only one row buffer per kernel");
+            arg_list.push_back(row_n);
+            arg_list.push_back(rowh);
+            arg_list.push_back(sloth);
+            arg_list.push_back(intw);
+            arg_list.push_back(cubh);
+            arg_list.push_back(cubw);
+            cur_stage = Resize::BilinearSeparable(
+                resize_shape, iter_vars, intermediate, cubh, cubw, row_n, rowh,
+                sloth, intw, resize_row, intermediate == gray_stage);
+            arg_list.push_back(resize_row);
+          }
+        } else {
+          ELENA_ABORT("Resize only receive uint8_t and float32 dtypes");
+        }
+      } else if (ResizeInterpolation == Area) {
+        ELENA_ASSERT(target == CPU, "Area resize is only supported on cpu");
+        ELENA_ASSERT(!resize_row, "only one row buffer per kernel");
+        bool is_float = intermediate->get_dtype() == ir::ScalarType::Float32;
+        ir::TensorVarPtr area_wh, area_ww;
+        if (is_float) {
+          area_wh = api::placeholder<float>({resize_h, area_kh}, "area_fwh");
+          area_ww = api::placeholder<float>({resize_w, area_kw}, "area_fww");
+          if (format <= BGRA) ResizeFloat = true;
+        } else {
+          area_wh = api::placeholder<int16_t>({resize_h, area_kh}, "area_wh");
+          area_ww = api::placeholder<int16_t>({resize_w, area_kw}, "area_ww");
+        }
+        arg_list.push_back(area_kh);
+        arg_list.push_back(area_kw);
+        arg_list.push_back(areah);
+        arg_list.push_back(areaw);
+        arg_list.push_back(area_wh);
+        arg_list.push_back(area_ww);
+        cur_stage = Resize::Area(resize_shape, iter_vars, intermediate,
+                                 area_wh, area_ww, areah, areaw, resize_row,
+                                 intermediate == gray_stage);
+        arg_list.push_back(resize_row);
+      } else if (ResizeInterpolation == Bicubic) {
+        ELENA_ASSERT(target == CPU, "Bicubic resize is only supported on cpu");
+        ir::TensorVarPtr cubic_wh, cubic_ww;
+        if (intermediate->get_dtype() == ir::ScalarType::Float32) {
+          cubic_wh = api::placeholder<float>({four, resize_h}, "cubic_fwh");
+          cubic_ww = api::placeholder<float>({four, resize_w}, "cubic_fww");
+          if (format <= BGRA) ResizeFloat = true;
+        } else {
+          cubic_wh = api::placeholder<int16_t>({four, resize_h}, "cubic_wh");
+          cubic_ww = api::placeholder<int16_t>({four, resize_w}, "cubic_ww");
+        }
+        arg_list.push_back(cubich);
+        arg_list.push_back(cubicw);
+        arg_list.push_back(cubic_wh);
+        arg_list.push_back(cubic_ww);
+        cur_stage = Resize::Bicubic(resize_shape, iter_vars, intermediate,
+                                    cubic_wh, cubic_ww, cubich, cubicw);
+      } else if (ResizeInterpolation == Pil) {
+        ELENA_ASSERT(target == CPU, "Pil resize is only supported on cpu");
+        ELENA_ASSERT(!resize_row, "only one row buffer per kernel");
+        ir::TensorVarPtr pil_wh, pil_ww;
+        if (intermediate->get_dtype() == ir::ScalarType::Float32) {
+          pil_wh = api::placeholder<float>({resize_h, pil_kh}, "pil_fwh");
+          pil_ww = api::placeholder<float>({resize_w, pil_kw}, "pil_fww");
+          if (format <= BGRA) ResizeFloat = true;
+        } else {
+          pil_wh = api::placeholder<int32_t>({resize_h, pil_kh}, "pil_wh");
+          pil_ww = api::placeholder<int32_t>({resize_w, pil_kw}, "pil_ww");
+        }
+        arg_list.push_back(pil_kh);
+        arg_list.push_back(pil_kw);
+        arg_list.push_back(pilh);
+        arg_list.push_back(pilw);
+        arg_list.push_back(pil_wh);
+        arg_list.push_back(pil_ww);
+        cur_stage = Resize::Pil(resize_shape, iter_vars, intermediate, pil_wh,
+                                pil_ww, pilh, pilw, resize_row,
+                                intermediate == gray_stage);
+        arg_list.push_back(resize_row);
+      } else {
+        ELENA_ABORT("not support temporarily in Resize");
+      }
+      if (op == "Letterbox") {
+        // resize_h x resize_w and the offsets come from letterbox_shape, the
+        // image is centred in the pad_h x pad_w output.
+        stage_list.push_back(cur_stage);
+        std::vector<ir::ExprPtr> box_shape{pad_h, pad_w,
+                                           cur_stage->shape->element[2]};
+        iter_vars = api::construct_indices(box_shape);
+        pad_input = cur_stage;
+        cur_stage = Pad::Letterbox(box_shape, iter_vars, cur_stage,
+                                   {pad_top, pad_left}, pad_value);
+        pad_stage = cur_stage;
+        letterbox = true;
+      }
+    } else if (op == "WarpAffine") {
+      ELENA_ASSERT(target == CPU, "WarpAffine is only supported on cpu");
+      // the warped image is resize_h x resize_w.
+      std::vector<ir::ExprPtr> warp_shape{resize_h, resize_w,
+                                          intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(warp_shape);
+      arg_list.push_back(warph);
+      arg_list.push_back(warpw);
+      if (ResizeInterpolation == Nearest) {
+        cur_stage = Warp::AffineNearest(warp_shape, iter_vars, intermediate,
+                                        warph, warpw, pad_value);
+      } else if (ResizeInterpolation == Bilinear) {
+        cur_stage = Warp::AffineBilinear(warp_shape, iter_vars, intermediate,
+                                         warph, warpw, pad_value);
+      } else {
+        ELENA_ABORT("WarpAffine supports nearest and bilinear only");
+      }
+    } else if (op == "CenterCrop") {
+      std::vector<ir::ExprPtr> crop_shape{crop_h, crop_w,
+                                          intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(crop_shape);
+      cur_stage = Crop::Crop(crop_shape, iter_vars, intermediate, crop_top,
+                             crop_left);
+    } else if (op == "FlipH" || op == "FlipV") {
+      std::vector<ir::ExprPtr> flip_shape{intermediate->shape->element[0],
+                                          intermediate->shape->element[1],
+                                          intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(flip_shape);
+      cur_stage = Remap::Flip(flip_shape, iter_vars, intermediate,
+                              op == "FlipH", op == "FlipV");
+    } else if (op == "Rotate90" || op == "Rotate180" || op == "Rotate270") {
+      int angle = std::stoi(op.substr(6));
+      bool swap = angle != 180;
+      std::vector<ir::ExprPtr> rotate_shape{
+          intermediate->shape->element[swap ? 1 : 0],
+          intermediate->shape->element[swap ? 0 : 1],
+          intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(rotate_shape);
+      cur_stage =
+          Remap::Rotate(rotate_shape, iter_vars, intermediate, angle);
+      transposed = transposed != swap;
+    } else if (op == "CastFloat") {
+      std::vector<ir::ExprPtr> cast_shape{intermediate->shape->element[0],
+                                          intermediate->shape->element[1],
+                                          intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(cast_shape);
+      cur_stage = Common::CastFloat(cast_shape, iter_vars, intermediate);
+    } else if (op == "CastHalf") {
+      std::vector<ir::ExprPtr> cast_shape{intermediate->shape->element[0],
+                                          intermediate->shape->element[1],
+                                          intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(cast_shape);
+      cur_stage =
+          Common::CastHalf(cast_shape, iter_vars, intermediate, OutputType);
+    } else if (op == "cvtColorRGB") {
+      ELENA_ASSERT(CvtFormat == BGR, "");
+      std::vector<ir::ExprPtr> rgb_shape{intermediate->shape->element[0],
+                                         intermediate->shape->element[1],
+                                         intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(rgb_shape);
+      cur_stage = CvtColor::BGR2RGB(rgb_shape, iter_vars, intermediate);
+    } else if (op == "Normalize") {
+      bool after_pad = pad_stage && intermediate == pad_stage;
+      auto norm_input = after_pad ? pad_input : intermediate;
+      std::vector<ir::ExprPtr> norm_shape{norm_input->shape->element[0],
+                                          norm_input->shape->element[1],
+                                          norm_input->shape->element[2]};
+      iter_vars = api::construct_indices(norm_shape);
+      cur_stage = Norm::AffineNorm(norm_shape, iter_vars, norm_input,
+                                   scale_value, bias_value);
+      if (after_pad) {
+        // Pad the normalized image with the normalized pad value, so that
+        // padded pixels stay constant stores.
+        stage_list.pop_back();
+        stage_list.push_back(cur_stage);
+        std::vector<ir::ExprPtr> padding_tlbr{pad_top, pad_left, pad_bottom,
+                                              pad_right};
+        std::vector<ir::ExprPtr> pad_shape{pad_h, pad_w,
+                                           cur_stage->shape->element[2]};
+        iter_vars = api::construct_indices(pad_shape);
+        auto norm_pad_value = pad_value * (*scale_value)(iter_vars[2]) +
+                              (*bias_value)(iter_vars[2]);
+        cur_stage =
+            letterbox
+                ? Pad::Letterbox(pad_shape, iter_vars, cur_stage,
+                                 {pad_top, pad_left}, norm_pad_value)
+                : Pad::Pad(pad_shape, iter_vars, cur_stage, padding_tlbr,
+                           norm_pad_value);
+        pad_stage = cur_stage;
+        pad_input = stage_list.back();
+      }
+    } else if (op == "Pad") {
+      std::vector<ir::ExprPtr> padding_tlbr{pad_top, pad_left, pad_bottom,
+                                            pad_right};
+      std::vector<ir::ExprPtr> pad_shape{pad_h, pad_w,
+                                         intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(pad_shape);
+      cur_stage = Pad::Pad(pad_shape, iter_vars, intermediate, padding_tlbr,
+                           pad_value);
+      pad_stage = cur_stage;
+      pad_input = intermediate;
+      letterbox = false;
+    } else if (op == "HWC2CHW") {
+      std::vector<ir::ExprPtr> trans_shape{intermediate->shape->element[2],
+                                           intermediate->shape->element[0],
+                                           intermediate->shape->element[1]};
+      std::vector<ir::ExprPtr> trans_iter{intermediate->shape->element[0],
+                                          intermediate->shape->element[1],
+                                          intermediate->shape->element[2]};
+      iter_vars = api::construct_indices(trans_iter);
+      cur_stage =
+          LayoutTrans::HWC2CHW(trans_shape, iter_vars, intermediate);
+    } else {
+      ELENA_ABORT("not support this " << op << " op temporarily");
+    }
+
+    stage_list.push_back(cur_stage);
+    intermediate = cur_stage;
+  }
+
+  auto sch = api::create_schedule(intermediate->op);
+
+  std::string final_op = stage_list[stage_list.size() - 1]->get_name();
+  for (auto stage : stage_list) {
+    if (stage->get_name() != final_op) {
+      (*sch)[stage]->compute_inline();
+    }
+  }
+  // The per-channel parameters are selects on the channel index, inlined
+  // into the unrolled channel loop they fold to one scalar per channel.
+  // 'scale' and 'bias' fold to loop-invariant expressions of the kernel
+  // arguments, so the element loop stays a single multiply-add.
+  for (auto param : {scale_value, bias_value, nv2bgr_params}) {
+    if (param && (*sch)[param->op]) (*sch)[param->op]->compute_inline();
+  }
+  // The channel extent is the constant 1, 3 or 4, so it unrolls completely.
+  if (iter_vars.size() == 3) {
+    (*sch)[intermediate->op]->unroll(iter_vars[2], 4);
+  }
+  // The row pass is not inlined, its channels unroll the same way.
+  if (resize_row) {
+    auto row_op = ir::ptr_cast<ir::ComputeOp>(resize_row->op);
+    (*sch)[resize_row->op]->unroll(row_op->iter_vars->element[2], 4);
+  }
+
+  if (target == CUDA) {
+    auto h_bind = (*sch)[intermediate->op]->split(
+        iter_vars[0], api::constant<uint64_t>(BLOCK_SIZE));
+    auto w_bind = (*sch)[intermediate->op]->split(
+        iter_vars[1], api::constant<uint64_t>(BLOCK_SIZE));
+    (*sch)[intermediate->op]->set_bind(h_bind.element[0], "blockIdx.y");
+    (*sch)[intermediate->op]->set_bind(h_bind.element[1], "threadIdx.y");
+    (*sch)[intermediate->op]->set_bind(w_bind.element[0], "blockIdx.x");
+    (*sch)[intermediate->op]->set_bind(w_bind.element[1], "threadIdx.x");
+  } else if (UnrollFactor > 1) {
+    // iter_vars[1] walks the columns for both HWC and CHW outputs.
+    (*sch)[intermediate->op]->unroll(iter_vars[1], UnrollFactor);
+  }
+
+  auto build_end = std::chrono::steady_clock::now();
+
+  LoweringContext lowering;
+  lowering.schedule = sch;
+  for (const auto &dim : {h, w, resize_h, resize_w, crop_h, crop_w, crop_top,
+                          crop_left, pad_h, pad_w, pad_top, pad_left,
+                          pad_bottom, pad_right}) {
+    lowering.var_max[dim->get_name()] = MAX_IMAGE_SIZE;
+  }
+  lowering.var_max[row_n->get_name()] = 2 * MAX_IMAGE_SIZE;
+  lowering.vectorize = target == CPU;
+  pass_manager.run(&lowering);
+  auto stmt = lowering.stmt;
+
+  auto codegen_start = std::chrono::steady_clock::now();
+
+  std::string kernel_name = KernelName(format, ResizeInterpolation);
+
+  arg_list.push_back(img);
+  arg_list.push_back(intermediate);
+  arg_list.push_back(h);
+  arg_list.push_back(w);
+
+  std::string code = target == CUDA
+                         ? api::genCudaSrc(stmt, arg_list, kernel_name)
+                         : api::genX86Src(stmt, arg_list, kernel_name);
+
+  if (timing) {
+    auto codegen_end = std::chrono::steady_clock::now();
+    timing->build_ms =
+        std::chrono::duration<double, std::milli>(build_end - build_start)
+            .count();
+    timing->codegen_ms =
+        std::chrono::duration<double, std::milli>(codegen_end - codegen_start)
+            .count();
+  }
+  return code;
+}
+
+}  // namespace Fuse
@@ -34,7 +34,8 @@ struct PadArgs {
 };
 
 void readOpList(const std::string &filepath, std::vector<std::string> &OpList,
-                Format &CvtFormat) {
+                Format &CvtFormat,
+                std::vector<Interpolation> &ResizeInterpolations) {
   Json::Reader reader;
   Json::Value root;
 
@@ -53,13 +54,68 @@ void readOpList(const std::string &filepath, std::vector<std::string> &OpList,
 
       auto mem = root[i];
 
+      if (type == "Resize" || type == "Letterbox") {
+        string interpolation = mem.get("interpolation", "bilinear").asString();
+        string backend = mem.get("backend", "cv2").asString();
+        // nearest and bilinear kernels are always generated.
+        if (backend == "pillow") {
+          if (interpolation == "bilinear" || interpolation == "bicubic")
+            ResizeInterpolations.push_back(Pil);
+          else
+            ELENA_WARN("unsupported pillow interpolation " << interpolation);
+        } else if (interpolation == "area") {
+          ResizeInterpolations.push_back(Area);
+        } else if (interpolation == "bicubic") {
+          ResizeInterpolations.push_back(Bicubic);
+        } else if (interpolation != "nearest" && interpolation != "bilinear") {
+          ELENA_WARN("unrecognized Resize interpolation " << interpolation);
+        }
+      }
+
+      if (type == "WarpAffine" || type == "CropResizeBatch") {
+        // nearest and bilinear kernels are always generated.
+        string interpolation = mem.get("interpolation", "bilinear").asString();
+        if (interpolation != "nearest" && interpolation != "bilinear")
+          ELENA_WARN("unsupported " << type << " interpolation "
+                                    << interpolation);
+      }
+
+      // the direction and the angle are part of the op name, the remap is
+      // fixed in the kernel.
+      if (type == "Flip") {
+        string direction = mem.get("direction", "horizontal").asString();
+        if (direction == "horizontal" || direction == "h")
+          OpList.back() = "FlipH";
+        else if (direction == "vertical" || direction == "v")
+          OpList.back() = "FlipV";
+        else if (direction == "diagonal")
+          OpList.back() = "Rotate180";
+        else
+          ELENA_ABORT("unrecognized Flip direction " << direction);
+        continue;
+      }
+      if (type == "Rotate") {
+        // clockwise, as mmcv.imrotate
+        int angle = ((mem.get("angle", 90).asInt() % 360) + 360) % 360;
+        if (angle == 0)
+          OpList.pop_back();
+        else if (angle % 90 == 0)
+          OpList.back() = "Rotate" + std::to_string(angle);
+        else
+          ELENA_ABORT("Rotate supports multiples of 90 degrees only, "
+                      "use WarpAffine for other angles");
+        continue;
+      }
+
       if (type == "cvtColorBGR")
         CvtFormat = BGR;
       else if (type == "cvtColorGray")
         CvtFormat = GRAY;
-      else if (type != "Resize" && type != "CenterCrop" &&
-               type != "Normalize" && type != "Pad" && type != "CastFloat" &&
-               type != "cvtColorRGB" && type != "HWC2CHW")
+      else if (type != "Resize" && type != "Letterbox" &&
+               type != "CenterCrop" && type != "Normalize" && type != "Pad" &&
+               type != "WarpAffine" && type != "CropResizeBatch" &&
+               type != "CastFloat" && type != "cvtColorRGB" &&
+               type != "HWC2CHW")
         ELENA_ABORT("unrecognized op type");
     }
   } else {
@@ -40,4 +40,59 @@ ir::TensorVarPtr Norm(const std::vector<ir::ExprPtr> &shape,
                       "Norm");
 }
 
+/// Per-channel values as a small tensor indexed by the channel, meant to be
+/// inlined into an unrolled channel loop.
+ir::TensorVarPtr ChannelParams(const std::vector<ir::ExprPtr> &values,
+                               const std::string &name) {
+  ELENA_ASSERT(values.size() == 1 || values.size() == 3, "ChannelParams");
+
+  std::vector<ir::ExprPtr> shape{api::constant<uint64_t>(values.size())};
+  auto iter = api::construct_indices(shape);
+  if (values.size() == 1) return api::compute(shape, iter, values[0], name);
+
+  auto C0 = api::logical::eq(iter[0], api::constant<int>(0));
+  auto C1 = api::logical::eq(iter[0], api::constant<int>(1));
+  return api::compute(
+      shape, iter,
+      api::if_then_else(C0, values[0],
+                        api::if_then_else(C1, values[1], values[2])),
+      name);
+}
+
+/// 'scale = 1 / std' of AffineNorm.
+ir::TensorVarPtr Scale(const std::vector<ir::ExprPtr> &std_value) {
+  std::vector<ir::ExprPtr> scale;
+  for (auto &s : std_value) scale.push_back(api::constant<float>(1) / s);
+  return ChannelParams(scale, "norm_scale");
+}
+
+/// 'bias = -mean / std' of AffineNorm.
+ir::TensorVarPtr Bias(const std::vector<ir::ExprPtr> &mean_value,
+                      const std::vector<ir::ExprPtr> &std_value) {
+  ELENA_ASSERT(mean_value.size() == std_value.size(), "Bias");
+  std::vector<ir::ExprPtr> bias;
+  for (size_t i = 0; i < mean_value.size(); ++i)
+    bias.push_back(-(mean_value[i] / std_value[i]));
+  return ChannelParams(bias, "norm_bias");
+}
+
+/// FloatNorm rewritten as one multiply-add per element,
+/// 'input * scale[c] + bias[c]'.  See Scale and Bias.
+ir::TensorVarPtr AffineNorm(const std::vector<ir::ExprPtr> &shape,
+                            ir::Array<ir::IterVar> iter_vars,
+                            ir::TensorVarPtr input, ir::TensorVarPtr scale,
+                            ir::TensorVarPtr bias,
+                            const std::string &name = "AffineNorm") {
+  ELENA_ASSERT(
+      ptr_cast<Const<uint64_t>>(shape[2])->get_value() ==
+          ptr_cast<Const<uint64_t>>(input->shape->element[2])->get_value(),
+      "AffineNorm");
+
+  return api::compute(shape, iter_vars,
+                      (*input)(iter_vars[0], iter_vars[1], iter_vars[2]) *
+                              (*scale)(iter_vars[2]) +
+                          (*bias)(iter_vars[2]),
+                      name);
+}
+
 }  // namespace Norm
@@ -52,4 +52,40 @@ ir::TensorVarPtr Pad(const std::vector<ir::ExprPtr> &shape,
       "pad");
 }
 
+/// The resized image placed at 'offset_tl' (top, left) of the letterbox of
+/// the given shape, the rest is filled with pad_value.  An integer image is
+/// still uint8 data, so pad_value is rounded and saturated to [0, 255] as
+/// OpenCV's copyMakeBorder does.
+ir::TensorVarPtr Letterbox(const std::vector<ir::ExprPtr> &shape,
+                           ir::Array<ir::IterVar> iter_vars,
+                           ir::TensorVarPtr input,
+                           std::vector<ir::ExprPtr> offset_tl,
+                           ir::ExprPtr pad_value,
+                           const std::string &name = "Letterbox") {
+  ELENA_ASSERT(shape.size() == input->shape->size(), "Letterbox");
+  // a uint8 image is letterboxed before CastFloat.
+  if (input->get_dtype() != ir::ScalarType::Float32 &&
+      pad_value->get_dtype() != input->get_dtype()) {
+    pad_value = max(min(round(pad_value), api::constant<float>(255)),
+                    api::constant<float>(0));
+    pad_value = cast(pad_value, input->get_dtype());
+  }
+
+  std::vector<ir::ExprPtr> condition;
+  condition.push_back(api::logical::ge(iter_vars[0], offset_tl[0]));
+  condition.push_back(api::logical::lt(
+      iter_vars[0], input->shape->element[0] + offset_tl[0]));
+  condition.push_back(api::logical::ge(iter_vars[1], offset_tl[1]));
+  condition.push_back(api::logical::lt(
+      iter_vars[1], input->shape->element[1] + offset_tl[1]));
+
+  return api::compute(
+      shape, iter_vars,
+      api::if_then_else(api::logical::all(condition),
+                        (*input)(iter_vars[0] - offset_tl[0],
+                                 iter_vars[1] - offset_tl[1], iter_vars[2]),
+                        pad_value),
+      "letterbox");
+}
+
 }  // namespace Pad
@@ -0,0 +1,53 @@
+#include <iostream>
+
+#include "api.h"
+
+using namespace ir;
+
+namespace Remap {
+
+/// Mirror image of the input, left to right when 'horizontal' is set, top to
+/// bottom when 'vertical' is set.  Like Crop::Crop it only changes the source
+/// index, the output is still written in order.
+ir::TensorVarPtr Flip(const std::vector<ir::ExprPtr> &shape,
+                      ir::Array<ir::IterVar> iter_vars, ir::TensorVarPtr input,
+                      bool horizontal, bool vertical,
+                      const std::string &name = "Flip") {
+  ELENA_ASSERT(shape.size() == input->shape->size(), "Flip");
+
+  auto one = api::constant<uint64_t>(1);
+  ir::ExprPtr y = iter_vars[0], x = iter_vars[1];
+  if (vertical) y = input->shape->element[0] - one - iter_vars[0];
+  if (horizontal) x = input->shape->element[1] - one - iter_vars[1];
+  return api::compute(shape, iter_vars, (*input)(y, x, iter_vars[2]), name);
+}
+
+/// The input rotated clockwise by 'angle' (90, 180 or 270) degrees, as
+/// cv::rotate.  For 90 and 270 degrees the output is w x h and its rows are
+/// columns of the input.
+ir::TensorVarPtr Rotate(const std::vector<ir::ExprPtr> &shape,
+                        ir::Array<ir::IterVar> iter_vars,
+                        ir::TensorVarPtr input, int angle,
+                        const std::string &name = "Rotate") {
+  ELENA_ASSERT(shape.size() == input->shape->size(), "Rotate");
+
+  auto one = api::constant<uint64_t>(1);
+  auto last_y = input->shape->element[0] - one;
+  auto last_x = input->shape->element[1] - one;
+  ir::ExprPtr y, x;
+  if (angle == 90) {
+    y = last_y - iter_vars[1];
+    x = iter_vars[0];
+  } else if (angle == 180) {
+    y = last_y - iter_vars[0];
+    x = last_x - iter_vars[1];
+  } else if (angle == 270) {
+    y = iter_vars[1];
+    x = last_x - iter_vars[0];
+  } else {
+    ELENA_ABORT("Rotate supports 90, 180 and 270 degrees only");
+  }
+  return api::compute(shape, iter_vars, (*input)(y, x, iter_vars[2]), name);
+}
+
+}  // namespace Remap
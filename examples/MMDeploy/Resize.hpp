@@ -37,6 +37,22 @@ ir::TensorVarPtr Nearest(const std::vector<ir::ExprPtr> &shape,
       name);
 }
 
+/// Nearest with the source row and column of every output row and column
+/// precomputed by nearest_resize_preprocess (the same float multiply and
+/// floor as Nearest), so the kernel only gathers.
+ir::TensorVarPtr NearestTable(const std::vector<ir::ExprPtr> &shape,
+                              ir::Array<ir::IterVar> iter_vars,
+                              ir::TensorVarPtr input, ir::TensorVarPtr nearh,
+                              ir::TensorVarPtr nearw,
+                              const std::string &name = "ResizeNearest") {
+  ELENA_ASSERT(shape.size() == input->shape->size(), "ResizeNearest");
+
+  return api::compute(shape, iter_vars,
+                      (*input)((*nearh)(iter_vars[0]), (*nearw)(iter_vars[1]),
+                               iter_vars[2]),
+                      name);
+}
+
 ir::TensorVarPtr Bilinear(const std::vector<ir::ExprPtr> &shape,
                           ir::Array<ir::IterVar> iter_vars,
                           ir::TensorVarPtr input, ir::TensorVarPtr cubfh,
@@ -66,6 +82,179 @@ ir::TensorVarPtr Bilinear(const std::vector<ir::ExprPtr> &shape,
       name);
 }
 
+/// Bilinear with the horizontal and the vertical interpolation separated, as
+/// OpenCV's resize does: 'row' blends the two columns of every source row
+/// the output reads, the result blends two rows of 'row'.  'rowh' holds the
+/// 'row_n' distinct source rows of the taps and 'sloth' the row of 'row'
+/// of every tap (bilinear_resize_rows), so a source row is interpolated
+/// once however many output rows read it: an element reads two source
+/// values and two rows rather than four source values.  The integer sum,
+/// and so the 11-bit fixed-point result, is exactly that of Bilinear.
+/// 'row' is returned for the caller to pass as a buffer, not inlined.  The
+/// channels of a 'gray' input are equal, its row keeps one.
+ir::TensorVarPtr BilinearSeparable(const std::vector<ir::ExprPtr> &shape,
+                                   ir::Array<ir::IterVar> iter_vars,
+                                   ir::TensorVarPtr input,
+                                   ir::TensorVarPtr cubfh,
+                                   ir::TensorVarPtr cubfw, ir::ExprPtr row_n,
+                                   ir::TensorVarPtr rowh,
+                                   ir::TensorVarPtr sloth,
+                                   ir::TensorVarPtr intw,
+                                   ir::TensorVarPtr &row, bool gray,
+                                   const std::string &name = "ResizeBilinear") {
+  ELENA_ASSERT(shape.size() == input->shape->size(), "ResizeBilinear");
+
+  auto zero = api::constant<uint64_t>(0);
+  auto one = api::constant<uint64_t>(1);
+  std::vector<ir::ExprPtr> row_shape{row_n, shape[1], shape[2]};
+  if (gray) row_shape[2] = one;
+  auto row_iter = api::construct_indices(row_shape);
+  auto src_y = (*rowh)(row_iter[0]);
+  auto row_sum =
+      (*cubfw)(zero, row_iter[1]) *
+          (*input)(src_y, (*intw)(zero, row_iter[1]), row_iter[2]) +
+      (*cubfw)(one, row_iter[1]) *
+          (*input)(src_y, (*intw)(one, row_iter[1]), row_iter[2]);
+  row = api::compute(
+      row_shape, row_iter,
+      std::make_shared<ir::Cast>(row_sum, ir::ScalarType::Int32), name + "Row");
+
+  ir::ExprPtr channel = iter_vars[2];
+  if (gray) channel = zero;
+  return api::compute(
+      shape, iter_vars,
+      ((*cubfh)(zero, iter_vars[0]) *
+           (*row)((*sloth)(zero, iter_vars[0]), iter_vars[1], channel) +
+       (*cubfh)(one, iter_vars[0]) *
+           (*row)((*sloth)(one, iter_vars[0]), iter_vars[1], channel) +
+       api::constant<int>(2097152)) /
+          api::constant<int>(4194304),  //  (... + 1 << (22 - 1)) >> 22
+      name);
+}
+
+/// Weighted sum of the source pixels in a window of runtime size around every
+/// output pixel, in two passes: 'row' sums the window of every output column
+/// for every source row, the result sums the window of rows of every output
+/// row, so a source row is weighted once rather than once per output row
+/// whose window holds it.  'tab' holds the first source row (column) of the
+/// window and its size, 'weight' the weights of each output row (column).
+/// 'row_func' and 'col_func' are the runtime helpers iterating the windows,
+/// they take the (inlined) source pixel and the row as a function of the
+/// window iterator.  'row' is returned for the caller to pass as a buffer,
+/// not inlined.  The channels of a 'gray' input are equal, its row keeps
+/// one.
+ir::TensorVarPtr WindowSum(ir::CallFunction row_func, ir::CallFunction col_func,
+                           const std::vector<ir::ExprPtr> &shape,
+                           ir::Array<ir::IterVar> iter_vars,
+                           ir::TensorVarPtr input, ir::TensorVarPtr weighth,
+                           ir::TensorVarPtr weightw, ir::TensorVarPtr tabh,
+                           ir::TensorVarPtr tabw, ir::TensorVarPtr &row,
+                           bool gray, const std::string &name) {
+  ELENA_ASSERT(shape.size() == input->shape->size(), name);
+
+  auto zero = api::constant<uint64_t>(0);
+  auto one = api::constant<uint64_t>(1);
+  // uint8 rows keep the integer sum, float ones the float sum.
+  auto row_dtype = input->get_dtype() == ir::ScalarType::Float32
+                       ? ir::ScalarType::Float32
+                       : ir::ScalarType::Int32;
+  std::vector<ir::ExprPtr> row_shape{input->shape->element[0], shape[1],
+                                     shape[2]};
+  if (gray) row_shape[2] = one;
+  auto row_iter = api::construct_indices(row_shape);
+  auto sx = api::construct_indices({input->shape->element[1]})[0];
+  std::vector<ir::ExprPtr> row_args{
+      (*input)(row_iter[0], sx, row_iter[2]), sx, (*tabw)(zero, row_iter[1]),
+      (*tabw)(one, row_iter[1]), (*weightw)(row_iter[1], zero)};
+  auto row_sum = std::make_shared<ir::Call>(
+      row_func, std::make_shared<ir::Array<ir::Expr>>(row_args), row_dtype);
+  // a Call as the whole fcompute would be evaluated for its side effects only.
+  row = api::compute(row_shape, row_iter,
+                     std::make_shared<ir::Cast>(row_sum, row_dtype),
+                     name + "Row");
+
+  auto sy = api::construct_indices({input->shape->element[0]})[0];
+  ir::ExprPtr channel = iter_vars[2];
+  if (gray) channel = zero;
+  std::vector<ir::ExprPtr> col_args{
+      (*row)(sy, iter_vars[1], channel), sy, (*tabh)(zero, iter_vars[0]),
+      (*tabh)(one, iter_vars[0]), (*weighth)(iter_vars[0], zero)};
+  auto sum = std::make_shared<ir::Call>(
+      col_func, std::make_shared<ir::Array<ir::Expr>>(col_args),
+      input->get_dtype());
+  return api::compute(shape, iter_vars,
+                      std::make_shared<ir::Cast>(sum, input->get_dtype()),
+                      name);
+}
+
+/// Area interpolation (OpenCV's INTER_AREA), meant for large downscales:
+/// every output pixel is the average of the source pixels it covers, each
+/// weighted by the covered fraction.  The weights are fixed-point with 11
+/// bits for uint8 input like Bilinear, float otherwise.
+ir::TensorVarPtr Area(const std::vector<ir::ExprPtr> &shape,
+                      ir::Array<ir::IterVar> iter_vars, ir::TensorVarPtr input,
+                      ir::TensorVarPtr weighth, ir::TensorVarPtr weightw,
+                      ir::TensorVarPtr tabh, ir::TensorVarPtr tabw,
+                      ir::TensorVarPtr &row, bool gray,
+                      const std::string &name = "ResizeArea") {
+  return WindowSum(ir::CallFunction::area_row, ir::CallFunction::area_col,
+                   shape, iter_vars, input, weighth, weightw, tabh, tabw, row,
+                   gray, name);
+}
+
+/// PIL's antialiased resampling (Image.resize with BILINEAR or BICUBIC): the
+/// filter support grows with the downscale factor, the tables come from
+/// pil_resize_preprocess.  uint8 input takes 22-bit fixed-point weights and
+/// is rounded and clipped after the horizontal pass like PIL's, so the
+/// result is PIL's exactly; float input takes the float weights.
+ir::TensorVarPtr Pil(const std::vector<ir::ExprPtr> &shape,
+                     ir::Array<ir::IterVar> iter_vars, ir::TensorVarPtr input,
+                     ir::TensorVarPtr weighth, ir::TensorVarPtr weightw,
+                     ir::TensorVarPtr tabh, ir::TensorVarPtr tabw,
+                     ir::TensorVarPtr &row, bool gray,
+                     const std::string &name = "ResizePil") {
+  return WindowSum(ir::CallFunction::pil_row, ir::CallFunction::pil_col,
+                   shape, iter_vars, input, weighth, weightw, tabh, tabw, row,
+                   gray, name);
+}
+
+/// Bicubic interpolation (OpenCV's INTER_CUBIC) over the 4x4 source pixels
+/// 'tabh' x 'tabw' of each output pixel, with the row and column 'weight's
+/// computed by bicubic_resize_preprocess.  uint8 input takes the 11-bit
+/// fixed-point weights and is rounded and saturated as OpenCV does, float
+/// input the float weights.  The columns are weighted first, as in
+/// BilinearSeparable.
+ir::TensorVarPtr Bicubic(const std::vector<ir::ExprPtr> &shape,
+                         ir::Array<ir::IterVar> iter_vars,
+                         ir::TensorVarPtr input, ir::TensorVarPtr weighth,
+                         ir::TensorVarPtr weightw, ir::TensorVarPtr tabh,
+                         ir::TensorVarPtr tabw,
+                         const std::string &name = "ResizeBicubic") {
+  ELENA_ASSERT(shape.size() == input->shape->size(), "ResizeBicubic");
+
+  ir::ExprPtr sum;
+  for (uint64_t k = 0; k < 4; ++k) {
+    auto tap_h = api::constant<uint64_t>(k);
+    ir::ExprPtr row;
+    for (uint64_t l = 0; l < 4; ++l) {
+      auto tap_w = api::constant<uint64_t>(l);
+      auto term = (*weightw)(tap_w, iter_vars[1]) *
+                  (*input)((*tabh)(tap_h, iter_vars[0]),
+                           (*tabw)(tap_w, iter_vars[1]), iter_vars[2]);
+      row = row ? row + term : term;
+    }
+    auto term = (*weighth)(tap_h, iter_vars[0]) * row;
+    sum = sum ? sum + term : term;
+  }
+
+  if (input->get_dtype() == ir::ScalarType::UInt8) {
+    //  (... + 1 << (22 - 1)) >> 22, saturated to uint8
+    sum = (sum + api::constant<int>(2097152)) / api::constant<int>(4194304);
+    sum = max(min(sum, api::constant<int>(255)), api::constant<int>(0));
+  }
+  return api::compute(shape, iter_vars, sum, name);
+}
+
 ir::TensorVarPtr BilinearFloat(const std::vector<ir::ExprPtr> &shape,
                                ir::Array<ir::IterVar> iter_vars,
                                ir::TensorVarPtr input, ir::TensorVarPtr cubfh,
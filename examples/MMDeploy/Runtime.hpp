@@ -2,6 +2,106 @@
 
 namespace Runtime {
 
+/* ----------------- NearestResize Preprocess ------------------ */
+/* the source row (column) of every output row (column) */
+static constexpr const char *cpu_nearest_preprocess_func = R"(
+
+extern "C" void nearest_resize_preprocess(uint64_t src, uint64_t dst, int32_t* __restrict__ tab) {
+  float scale = (float)src / (float)dst;
+  for (uint64_t d = 0; d < dst; ++d) {
+    uint64_t s = floor(d * scale);
+    tab[d] = s < src - 1 ? s : src - 1;
+  }
+}
+
+)";
+
+/* ----------------- Letterbox ------------------ */
+/* the largest size with the aspect ratio of the source fitting dst_h x dst_w,
+ * and the padding that centres it */
+static constexpr const char *letterbox_shape_func = R"(
+
+extern "C" void letterbox_shape(uint64_t src_h, uint64_t src_w, uint64_t dst_h, uint64_t dst_w,
+                                uint64_t* resize_h, uint64_t* resize_w, int32_t* pad_top, int32_t* pad_left,
+                                int32_t* pad_bottom, int32_t* pad_right) {
+  double scale_h = (double)dst_h / src_h;
+  double scale_w = (double)dst_w / src_w;
+  double scale = scale_h < scale_w ? scale_h : scale_w;
+  uint64_t h = (uint64_t)(src_h * scale + 0.5);
+  uint64_t w = (uint64_t)(src_w * scale + 0.5);
+  *resize_h = h < 1 ? 1 : (h > dst_h ? dst_h : h);
+  *resize_w = w < 1 ? 1 : (w > dst_w ? dst_w : w);
+  *pad_top = (dst_h - *resize_h) / 2;
+  *pad_left = (dst_w - *resize_w) / 2;
+  *pad_bottom = dst_h - *resize_h - *pad_top;
+  *pad_right = dst_w - *resize_w - *pad_left;
+}
+
+)";
+
+/* ----------------- WarpAffine Preprocess ------------------ */
+/* the inverse of the 2x3 matrix M (as cv::invertAffineTransform), split into
+   the source coordinates of every output row, warph[y] and warph[dst_h + y],
+   and the offsets added by every output column, warpw[x] and warpw[dst_w + x] */
+static constexpr const char *cpu_warp_preprocess_func = R"(
+
+extern "C" void warp_affine_preprocess(const double* M, uint64_t dst_h, uint64_t dst_w,
+                                       float* __restrict__ warph, float* __restrict__ warpw) {
+  double D = M[0] * M[4] - M[1] * M[3];
+  D = D != 0 ? 1. / D : 0;
+  double A11 = M[4] * D, A22 = M[0] * D, A12 = -M[1] * D, A21 = -M[3] * D;
+  float iM[6] = {(float)A11, (float)A12, (float)(-A11 * M[2] - A12 * M[5]),
+                 (float)A21, (float)A22, (float)(-A21 * M[2] - A22 * M[5])};
+  for (uint64_t y = 0; y < dst_h; ++y) {
+    warph[y] = iM[1] * y + iM[2];
+    warph[dst_h + y] = iM[4] * y + iM[5];
+  }
+  for (uint64_t x = 0; x < dst_w; ++x) {
+    warpw[x] = iM[0] * x;
+    warpw[dst_w + x] = iM[3] * x;
+  }
+}
+
+)";
+
+/* bilinear sample of the affine kernels at (sx, sy), 'pixel(y, x)' is the
+   source pixel and taps outside of the h x w image take 'border'. uint8
+   results are rounded half to even and saturated like OpenCV's */
+static constexpr const char *cpu_warp_bilinear_func = R"(
+
+template <typename F>
+inline auto warp_bilinear(F pixel, float sx, float sy, int32_t h, int32_t w, float border)
+    -> decltype(pixel(0, 0)) {
+  float x0f = floorf(sx), y0f = floorf(sy);
+  int32_t x0 = (int32_t)x0f, y0 = (int32_t)y0f;
+  float a = sx - x0f, b = sy - y0f;
+  float p00, p01, p10, p11;
+  if (x0 >= 0 && y0 >= 0 && x0 < w - 1 && y0 < h - 1) {
+    p00 = pixel(y0, x0);
+    p01 = pixel(y0, x0 + 1);
+    p10 = pixel(y0 + 1, x0);
+    p11 = pixel(y0 + 1, x0 + 1);
+  } else {
+    auto tap = [&](int32_t y, int32_t x) -> float {
+      return y >= 0 && y < h && x >= 0 && x < w ? (float)pixel(y, x) : border;
+    };
+    p00 = tap(y0, x0);
+    p01 = tap(y0, x0 + 1);
+    p10 = tap(y0 + 1, x0);
+    p11 = tap(y0 + 1, x0 + 1);
+  }
+  float top = p00 + a * (p01 - p00);
+  float bottom = p10 + a * (p11 - p10);
+  float value = top + b * (bottom - top);
+  if (std::is_same<decltype(pixel(0, 0)), uint8_t>::value) {
+    value = rintf(value);
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+  }
+  return value;
+}
+
+)";
+
 /* ----------------- BilinearResize Preprocess ------------------ */
 /* for uint8_t input */
 static constexpr const char *cpu_bilinear_preprocess_func = R"(
@@ -58,6 +158,32 @@ extern "C" void bilinear_resize_preprocess(uint64_t src_h, uint64_t src_w, uint6
   }
 }
 
+/* the distinct source rows of the taps inth of src_h rows, in the order the
+   output rows read them: rowh[r] is the r-th and sloth[k * dst_h + j] the r
+   of tap k of output row j.  The kernel interpolates each rowh horizontally
+   once, output rows sharing a source row share its interpolation. Returns
+   the number of rows, at most 2 * dst_h */
+extern "C" uint64_t bilinear_resize_rows(uint64_t src_h, uint64_t dst_h, const int32_t* __restrict__ inth,
+                       int32_t* __restrict__ rowh, int32_t* __restrict__ sloth) {
+  int32_t* slot = new int32_t[src_h];
+  for (uint64_t i = 0; i < src_h; ++i) slot[i] = -1;
+
+  uint64_t row_n = 0;
+  for (uint64_t j = 0; j < dst_h; ++j) {
+    for (uint64_t k = 0; k < 2; ++k) {
+      int32_t sh = inth[k * dst_h + j];
+      if (slot[sh] < 0) {
+        slot[sh] = row_n;
+        rowh[row_n++] = sh;
+      }
+      sloth[k * dst_h + j] = slot[sh];
+    }
+  }
+
+  delete[] slot;
+  return row_n;
+}
+
 )";
 
 /* for float input */
@@ -240,6 +366,225 @@ extern "C" __device__ void bilinear_float_resize_preprocess(uint64_t src_h, uint
 
 
 
+/* ----------------- AreaResize ------------------ */
+/* the two passes of the area kernels: area_row sums the window of source
+   pixels 'pixel(x)' of one output column into the row buffer, area_col the
+   window of buffered rows 'row(y)' of one output row */
+static constexpr const char *cpu_area_sum_func = R"(
+
+template <typename F>
+inline int32_t area_row(F pixel, int32_t sx, int32_t nx, const int16_t* __restrict__ wx) {
+  int32_t sum = 0;
+  for (int32_t j = 0; j < nx; ++j) sum += wx[j] * pixel(sx + j);
+  return sum;
+}
+
+template <typename F>
+inline int32_t area_col(F row, int32_t sy, int32_t ny, const int16_t* __restrict__ wy) {
+  int32_t sum = 0;
+  for (int32_t i = 0; i < ny; ++i) sum += wy[i] * row(sy + i);
+  return (sum + (1 << 21)) >> 22;
+}
+
+template <typename F>
+inline float area_row(F pixel, int32_t sx, int32_t nx, const float* __restrict__ wx) {
+  float sum = 0;
+  for (int32_t j = 0; j < nx; ++j) sum += wx[j] * pixel(sx + j);
+  return sum;
+}
+
+template <typename F>
+inline float area_col(F row, int32_t sy, int32_t ny, const float* __restrict__ wy) {
+  float sum = 0;
+  for (int32_t i = 0; i < ny; ++i) sum += wy[i] * row(sy + i);
+  return sum;
+}
+
+)";
+
+/* the source pixels covered by each output pixel of one axis, as OpenCV's
+   INTER_AREA: tab[d] is the first, tab[dst + d] the count, and 'taps'
+   weights per output pixel follow in 'weight' (11 bits, summing to 2048)
+   and 'weightf' */
+static constexpr const char *cpu_area_preprocess_func = R"(
+
+extern "C" uint64_t area_resize_taps(uint64_t src, uint64_t dst) {
+  return (uint64_t)ceil(double(src) / dst) + 1;
+}
+
+extern "C" void area_resize_preprocess(uint64_t src, uint64_t dst, uint64_t taps,
+                       int32_t* __restrict__ tab, int16_t* __restrict__ weight,
+                       float* __restrict__ weightf) {
+  double scale = double(src) / dst;
+  for (uint64_t d = 0; d < dst; ++d) {
+    double fs1 = d * scale;
+    double fs2 = fs1 + scale;
+    double cell = scale < src - fs1 ? scale : src - fs1;
+    int s1 = ceil(fs1), s2 = floor(fs2);
+    if (s2 > (int)src - 1) s2 = src - 1;
+    if (s1 > s2) s1 = s2;
+
+    float* wf = weightf + d * taps;
+    int first = s1, n = 0;
+    if (s1 - fs1 > 1e-3) {
+      first = s1 - 1;
+      wf[n++] = (s1 - fs1) / cell;
+    }
+    for (int s = s1; s < s2; ++s) wf[n++] = 1.0 / cell;
+    if (fs2 - s2 > 1e-3) {
+      double part = fs2 - s2 < 1 ? fs2 - s2 : 1;
+      wf[n++] = (part < cell ? part : cell) / cell;
+    }
+    tab[d] = first;
+    tab[dst + d] = n;
+
+    /* the rounding error goes to the largest weight */
+    int16_t* w = weight + d * taps;
+    int sum = 0, largest = 0;
+    for (int k = 0; k < n; ++k) {
+      w[k] = rint(wf[k] * 2048);
+      sum += w[k];
+      if (w[k] > w[largest]) largest = k;
+    }
+    w[largest] += 2048 - sum;
+  }
+}
+
+)";
+
+/* ----------------- BicubicResize Preprocess ------------------ */
+/* the 4 source pixels of each output pixel of one axis and their weights
+   (OpenCV's INTER_CUBIC, A = -0.75): tab[k * dst + d] is tap k of output
+   d, clamped to the image, 'weight' the 11-bit and 'weightf' the float
+   weights */
+static constexpr const char *cpu_bicubic_preprocess_func = R"(
+
+extern "C" void bicubic_resize_preprocess(uint64_t src, uint64_t dst,
+                       int32_t* __restrict__ tab, int16_t* __restrict__ weight,
+                       float* __restrict__ weightf) {
+  const float A = -0.75f;
+  float scale = double(src) / dst;
+
+  for (uint64_t d = 0; d < dst; ++d) {
+    float f = (float)((d + 0.5) * scale - 0.5f);
+    int s = floor(f);
+    f -= s;
+
+    float w[4];
+    w[0] = ((A * (f + 1) - 5 * A) * (f + 1) + 8 * A) * (f + 1) - 4 * A;
+    w[1] = ((A + 2) * f - (A + 3)) * f * f + 1;
+    w[2] = ((A + 2) * (1 - f) - (A + 3)) * (1 - f) * (1 - f) + 1;
+    w[3] = 1.f - w[0] - w[1] - w[2];
+
+    for (int k = 0; k < 4; ++k) {
+      int t = s - 1 + k;
+      tab[k * dst + d] = t < 0 ? 0 : (t >= (int)src ? (int)src - 1 : t);
+      weight[k * dst + d] = rint(w[k] * 2048);
+      weightf[k * dst + d] = w[k];
+    }
+  }
+}
+
+)";
+
+/* ----------------- PilResize ------------------ */
+/* the two passes of the pil kernels, as area_row and area_col.  The uint8
+   ones round and clip every pass, as PIL's two passes through an 8-bit
+   image do */
+static constexpr const char *cpu_pil_sum_func = R"(
+
+inline int32_t pil_clip8(int32_t v) {
+  v >>= 22;
+  return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+template <typename F>
+inline int32_t pil_row(F pixel, int32_t sx, int32_t nx, const int32_t* __restrict__ wx) {
+  int32_t sum = 1 << 21;
+  for (int32_t j = 0; j < nx; ++j) sum += wx[j] * pixel(sx + j);
+  return pil_clip8(sum);
+}
+
+template <typename F>
+inline int32_t pil_col(F row, int32_t sy, int32_t ny, const int32_t* __restrict__ wy) {
+  int32_t sum = 1 << 21;
+  for (int32_t i = 0; i < ny; ++i) sum += wy[i] * row(sy + i);
+  return pil_clip8(sum);
+}
+
+template <typename F>
+inline float pil_row(F pixel, int32_t sx, int32_t nx, const float* __restrict__ wx) {
+  float sum = 0;
+  for (int32_t j = 0; j < nx; ++j) sum += wx[j] * pixel(sx + j);
+  return sum;
+}
+
+template <typename F>
+inline float pil_col(F row, int32_t sy, int32_t ny, const float* __restrict__ wy) {
+  float sum = 0;
+  for (int32_t i = 0; i < ny; ++i) sum += wy[i] * row(sy + i);
+  return sum;
+}
+
+)";
+
+/* the source pixels of each output pixel of one axis as PIL's
+   precompute_coeffs: the support of the bilinear (1) or bicubic (2, a = -0.5)
+   filter is scaled by the downscale factor.  tab[d] is the first, tab[dst + d]
+   the count, and 'taps' weights per output pixel follow in 'weight' (22 bits)
+   and 'weightf' */
+static constexpr const char *cpu_pil_preprocess_func = R"(
+
+static double pil_filter(int cubic, double x) {
+  if (x < 0) x = -x;
+  if (!cubic) return x < 1 ? 1 - x : 0;
+  const double a = -0.5;
+  if (x < 1) return ((a + 2) * x - (a + 3)) * x * x + 1;
+  if (x < 2) return (((x - 5) * x + 8) * x - 4) * a;
+  return 0;
+}
+
+extern "C" uint64_t pil_resize_taps(uint64_t src, uint64_t dst, int cubic) {
+  double scale = double(src) / dst;
+  double support = (cubic ? 2.0 : 1.0) * (scale < 1 ? 1 : scale);
+  return (uint64_t)ceil(support) * 2 + 1;
+}
+
+extern "C" void pil_resize_preprocess(uint64_t src, uint64_t dst, uint64_t taps, int cubic,
+                       int32_t* __restrict__ tab, int32_t* __restrict__ weight,
+                       float* __restrict__ weightf) {
+  double scale = double(src) / dst;
+  double filterscale = scale < 1 ? 1 : scale;
+  double support = (cubic ? 2.0 : 1.0) * filterscale;
+  double* k = new double[taps];
+
+  for (uint64_t d = 0; d < dst; ++d) {
+    double center = (d + 0.5) * scale;
+    int xmin = (int)(center - support + 0.5);
+    int xmax = (int)(center + support + 0.5);
+    if (xmin < 0) xmin = 0;
+    if (xmax > (int)src) xmax = src;
+    xmax -= xmin;
+
+    double ww = 0;
+    for (int x = 0; x < xmax; ++x) {
+      k[x] = pil_filter(cubic, (x + xmin - center + 0.5) / filterscale);
+      ww += k[x];
+    }
+    for (int x = 0; x < xmax; ++x) {
+      if (ww != 0) k[x] /= ww;
+      weightf[d * taps + x] = k[x];
+      weight[d * taps + x] = (int32_t)(k[x] < 0 ? -0.5 + k[x] * (1 << 22)
+                                                : 0.5 + k[x] * (1 << 22));
+    }
+    tab[d] = xmin;
+    tab[dst + d] = xmax;
+  }
+  delete[] k;
+}
+
+)";
+
 /* ----------------- Prelude ------------------ */
 static constexpr const char *prelude = R"(
 #include <iostream>
@@ -261,6 +606,31 @@ static constexpr const char *prelude = R"(
 
 )";
 
+/* the kernels compute their indices in 32 bits, which only holds for
+   dimensions, crop and pad sizes up to MAX_IMAGE_SIZE, defined in front */
+static constexpr const char *check_image_size_func = R"(
+#define CHECK_IMAGE_SIZE(x)                                                 \
+  if ((x) > MAX_IMAGE_SIZE)                                                 \
+    ABORT(#x " = " << (x) << " exceeds MAX_IMAGE_SIZE " << MAX_IMAGE_SIZE)
+
+static void check_image_size(uint64_t resize_h, uint64_t resize_w, uint64_t crop_h, uint64_t crop_w, int32_t crop_top, int32_t crop_left, uint64_t pad_h, uint64_t pad_w, int32_t pad_top, int32_t pad_left, int32_t pad_bottom, int32_t pad_right, uint64_t src_h, uint64_t src_w) {
+    CHECK_IMAGE_SIZE(src_h);
+    CHECK_IMAGE_SIZE(src_w);
+    CHECK_IMAGE_SIZE(resize_h);
+    CHECK_IMAGE_SIZE(resize_w);
+    CHECK_IMAGE_SIZE(crop_h);
+    CHECK_IMAGE_SIZE(crop_w);
+    CHECK_IMAGE_SIZE(crop_top);
+    CHECK_IMAGE_SIZE(crop_left);
+    CHECK_IMAGE_SIZE(pad_h);
+    CHECK_IMAGE_SIZE(pad_w);
+    CHECK_IMAGE_SIZE(pad_top);
+    CHECK_IMAGE_SIZE(pad_left);
+    CHECK_IMAGE_SIZE(pad_bottom);
+    CHECK_IMAGE_SIZE(pad_right);
+}
+)";
+
 static constexpr const char *cuda_prelude = R"(
 #include <cuda_runtime.h>
 #define cuErrCheck(res)                                        \
@@ -274,7 +644,8 @@ static constexpr const char *cuda_prelude = R"(
 /* for cpu */
 static constexpr const char *cpu_call_func_begin = R"(
 
-extern "C" void FuseKernel(uint64_t resize_h, uint64_t resize_w, uint64_t crop_h, uint64_t crop_w, int32_t crop_top, int32_t crop_left, float norm_mean_0, float norm_mean_1, float norm_mean_2, float norm_std_0, float norm_std_1, float norm_std_2, uint64_t pad_h, uint64_t pad_w, int32_t pad_top, int32_t pad_left, int32_t pad_bottom, int32_t pad_right, float pad_value, uint8_t* __restrict__ src_raw_data, float* __restrict__ dst_raw_data, uint64_t src_h, uint64_t src_w, const char *format, const char *interpolation = "nearest"){
+extern "C" void FuseKernel(uint64_t resize_h, uint64_t resize_w, uint64_t crop_h, uint64_t crop_w, int32_t crop_top, int32_t crop_left, float norm_mean_0, float norm_mean_1, float norm_mean_2, float norm_std_0, float norm_std_1, float norm_std_2, uint64_t pad_h, uint64_t pad_w, int32_t pad_top, int32_t pad_left, int32_t pad_bottom, int32_t pad_right, float pad_value, uint8_t* __restrict__ src_raw_data, dst_t* __restrict__ dst_raw_data, uint64_t src_h, uint64_t src_w, const char *format, const char *interpolation = "nearest"){
+    check_image_size(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, src_h, src_w);
     if (resize_h && resize_w && EQUAL(interpolation, "nearest")) {
         if(EQUAL(format, "BGR")){
           BGR_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, src_raw_data, dst_raw_data, src_h, src_w);
@@ -293,6 +664,90 @@ extern "C" void FuseKernel(uint64_t resize_h, uint64_t resize_w, uint64_t crop_h
         }
     } )";
 
+/* with a Resize op the nearest kernels take precomputed source indices */
+static constexpr const char *cpu_nearest_call_func_begin = R"(
+
+extern "C" void FuseKernel(uint64_t resize_h, uint64_t resize_w, uint64_t crop_h, uint64_t crop_w, int32_t crop_top, int32_t crop_left, float norm_mean_0, float norm_mean_1, float norm_mean_2, float norm_std_0, float norm_std_1, float norm_std_2, uint64_t pad_h, uint64_t pad_w, int32_t pad_top, int32_t pad_left, int32_t pad_bottom, int32_t pad_right, float pad_value, uint8_t* __restrict__ src_raw_data, dst_t* __restrict__ dst_raw_data, uint64_t src_h, uint64_t src_w, const char *format, const char *interpolation = "nearest"){
+    check_image_size(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, src_h, src_w);
+    if (resize_h && resize_w && EQUAL(interpolation, "nearest")) {
+        int* nearh = new int[resize_h];
+        int* nearw = new int[resize_w];
+
+        nearest_resize_preprocess(src_h, resize_h, nearh);
+        nearest_resize_preprocess(src_w, resize_w, nearw);
+
+        if(EQUAL(format, "BGR")){
+          BGR_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+           ABORT("This format is not supported");
+        }
+
+        delete[] nearh;
+        delete[] nearw;
+    } )";
+
+/* with a WarpAffine op the kernels take the source coordinate tables of the
+   2x3 matrix, the output is resize_h x resize_w */
+static constexpr const char *cpu_warp_call_func_begin = R"(
+
+extern "C" void FuseKernel(uint64_t resize_h, uint64_t resize_w, uint64_t crop_h, uint64_t crop_w, int32_t crop_top, int32_t crop_left, float norm_mean_0, float norm_mean_1, float norm_mean_2, float norm_std_0, float norm_std_1, float norm_std_2, uint64_t pad_h, uint64_t pad_w, int32_t pad_top, int32_t pad_left, int32_t pad_bottom, int32_t pad_right, float pad_value, const double* warp_matrix, uint8_t* __restrict__ src_raw_data, dst_t* __restrict__ dst_raw_data, uint64_t src_h, uint64_t src_w, const char *format, const char *interpolation = "bilinear"){
+    check_image_size(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, src_h, src_w);
+    float* warph = new float[resize_h*2];
+    float* warpw = new float[resize_w*2];
+
+    warp_affine_preprocess(warp_matrix, resize_h, resize_w, warph, warpw);
+
+    if (EQUAL(interpolation, "nearest")) {
+        if(EQUAL(format, "BGR")){
+          BGR_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+    } else if (EQUAL(interpolation, "bilinear")) {
+        if(EQUAL(format, "BGR")){
+          BGR_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, warph, warpw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+    } else {
+      ABORT("This interpolation is not supported");
+    }
+
+    delete[] warph;
+    delete[] warpw;
+}
+)";
+
 static constexpr const char *cpu_bilinear_func = R"(
     else if(resize_h && resize_w && EQUAL(interpolation, "bilinear")){
         int* inth;
@@ -320,21 +775,28 @@ static constexpr const char *cpu_bilinear_func = R"(
           intw = new int[resize_w*2];
 
           bilinear_resize_preprocess(src_h, src_w, resize_h, resize_w, cubfh, cubfw, inth, intw);
+          int* rowh = new int[resize_h*2];
+          int* sloth = new int[resize_h*2];
+          uint64_t row_n = bilinear_resize_rows(src_h, resize_h, inth, rowh, sloth);
+          int* bilinear_rows = new int[row_n*resize_w*4];
 
           if(EQUAL(format, "BGR")){
-            BGR_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+            BGR_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, row_n, rowh, sloth, intw, cubfh, cubfw, bilinear_rows, src_raw_data, dst_raw_data, src_h, src_w);
           } else if(EQUAL(format, "RGB")){
-            RGB_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+            RGB_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, row_n, rowh, sloth, intw, cubfh, cubfw, bilinear_rows, src_raw_data, dst_raw_data, src_h, src_w);
           } else if(EQUAL(format, "GRAY")){
-            GRAY_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+            GRAY_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, row_n, rowh, sloth, intw, cubfh, cubfw, bilinear_rows, src_raw_data, dst_raw_data, src_h, src_w);
           } else if(EQUAL(format, "BGRA")){
-            BGRA_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+            BGRA_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, row_n, rowh, sloth, intw, cubfh, cubfw, bilinear_rows, src_raw_data, dst_raw_data, src_h, src_w);
           } else {
             ABORT("This format is not supported");
           }
 
           if (cubfh) delete[] cubfh;
           if (cubfw) delete[] cubfw;
+          delete[] rowh;
+          delete[] sloth;
+          delete[] bilinear_rows;
         }
 
         if (inth) delete[] inth;
@@ -377,10 +839,204 @@ static constexpr const char *cpu_bilinear_float_func = R"(
         if (intw) delete[] intw;
     })";
 
+static constexpr const char *cpu_area_func_begin = R"(
+    else if(resize_h && resize_w && EQUAL(interpolation, "area")){
+        uint64_t area_kh = area_resize_taps(src_h, resize_h);
+        uint64_t area_kw = area_resize_taps(src_w, resize_w);
+        int* areah = new int[resize_h*2];
+        int* areaw = new int[resize_w*2];
+        short* area_wh = new short[resize_h*area_kh];
+        short* area_ww = new short[resize_w*area_kw];
+        float* area_fwh = new float[resize_h*area_kh];
+        float* area_fww = new float[resize_w*area_kw];
+
+        area_resize_preprocess(src_h, resize_h, area_kh, areah, area_wh, area_fwh);
+        area_resize_preprocess(src_w, resize_w, area_kw, areaw, area_ww, area_fww);
+        /* the horizontal pass of every source row, up to 4 channels */
+        int* area_rows = new int[src_h*resize_w*4];
+        float* area_frows = reinterpret_cast<float*>(area_rows);
+
+)";
+
+/* uint8 kernels take the fixed-point weights, NV12 & NV21 is float dtype */
+static constexpr const char *cpu_area_func = R"(
+        if(EQUAL(format, "BGR")){
+          BGR_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_wh, area_ww, area_rows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_wh, area_ww, area_rows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_wh, area_ww, area_rows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_wh, area_ww, area_rows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_fwh, area_fww, area_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_fwh, area_fww, area_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+)";
+
+static constexpr const char *cpu_area_float_func = R"(
+        if(EQUAL(format, "BGR")){
+          BGR_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_fwh, area_fww, area_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_fwh, area_fww, area_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_fwh, area_fww, area_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_fwh, area_fww, area_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_fwh, area_fww, area_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Area_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, area_kh, area_kw, areah, areaw, area_fwh, area_fww, area_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+)";
+
+static constexpr const char *cpu_area_func_end = R"(
+        delete[] areah;
+        delete[] areaw;
+        delete[] area_wh;
+        delete[] area_ww;
+        delete[] area_fwh;
+        delete[] area_fww;
+        delete[] area_rows;
+    })";
+
+static constexpr const char *cpu_bicubic_func_begin = R"(
+    else if(resize_h && resize_w && EQUAL(interpolation, "bicubic")){
+        int* cubich = new int[resize_h*4];
+        int* cubicw = new int[resize_w*4];
+        short* cubic_wh = new short[resize_h*4];
+        short* cubic_ww = new short[resize_w*4];
+        float* cubic_fwh = new float[resize_h*4];
+        float* cubic_fww = new float[resize_w*4];
+
+        bicubic_resize_preprocess(src_h, resize_h, cubich, cubic_wh, cubic_fwh);
+        bicubic_resize_preprocess(src_w, resize_w, cubicw, cubic_ww, cubic_fww);
+
+)";
+
+/* uint8 kernels take the fixed-point weights, NV12 & NV21 is float dtype */
+static constexpr const char *cpu_bicubic_func = R"(
+        if(EQUAL(format, "BGR")){
+          BGR_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_wh, cubic_ww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_wh, cubic_ww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_wh, cubic_ww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_wh, cubic_ww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_fwh, cubic_fww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_fwh, cubic_fww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+)";
+
+static constexpr const char *cpu_bicubic_float_func = R"(
+        if(EQUAL(format, "BGR")){
+          BGR_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_fwh, cubic_fww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_fwh, cubic_fww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_fwh, cubic_fww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_fwh, cubic_fww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_fwh, cubic_fww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Bicubic_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, cubich, cubicw, cubic_fwh, cubic_fww, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+)";
+
+static constexpr const char *cpu_bicubic_func_end = R"(
+        delete[] cubich;
+        delete[] cubicw;
+        delete[] cubic_wh;
+        delete[] cubic_ww;
+        delete[] cubic_fwh;
+        delete[] cubic_fww;
+    })";
+
+static constexpr const char *cpu_pil_func_begin = R"(
+    else if(resize_h && resize_w && (EQUAL(interpolation, "pil_bilinear") || EQUAL(interpolation, "pil_bicubic"))){
+        int cubic = EQUAL(interpolation, "pil_bicubic");
+        uint64_t pil_kh = pil_resize_taps(src_h, resize_h, cubic);
+        uint64_t pil_kw = pil_resize_taps(src_w, resize_w, cubic);
+        int* pilh = new int[resize_h*2];
+        int* pilw = new int[resize_w*2];
+        int* pil_wh = new int[resize_h*pil_kh];
+        int* pil_ww = new int[resize_w*pil_kw];
+        float* pil_fwh = new float[resize_h*pil_kh];
+        float* pil_fww = new float[resize_w*pil_kw];
+
+        pil_resize_preprocess(src_h, resize_h, pil_kh, cubic, pilh, pil_wh, pil_fwh);
+        pil_resize_preprocess(src_w, resize_w, pil_kw, cubic, pilw, pil_ww, pil_fww);
+        /* the horizontal pass of every source row, up to 4 channels */
+        int* pil_rows = new int[src_h*resize_w*4];
+        float* pil_frows = reinterpret_cast<float*>(pil_rows);
+
+)";
+
+/* uint8 kernels take the fixed-point weights, NV12 & NV21 is float dtype */
+static constexpr const char *cpu_pil_func = R"(
+        if(EQUAL(format, "BGR")){
+          BGR_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_wh, pil_ww, pil_rows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_wh, pil_ww, pil_rows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_wh, pil_ww, pil_rows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_wh, pil_ww, pil_rows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_fwh, pil_fww, pil_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_fwh, pil_fww, pil_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+)";
+
+static constexpr const char *cpu_pil_float_func = R"(
+        if(EQUAL(format, "BGR")){
+          BGR_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_fwh, pil_fww, pil_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_fwh, pil_fww, pil_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_fwh, pil_fww, pil_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_fwh, pil_fww, pil_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_fwh, pil_fww, pil_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Pil_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, pil_kh, pil_kw, pilh, pilw, pil_fwh, pil_fww, pil_frows, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+)";
+
+static constexpr const char *cpu_pil_func_end = R"(
+        delete[] pilh;
+        delete[] pilw;
+        delete[] pil_wh;
+        delete[] pil_ww;
+        delete[] pil_fwh;
+        delete[] pil_fww;
+        delete[] pil_rows;
+    })";
+
 /* for cuda */
 static constexpr const char *cuda_call_func_begin = R"(
 
 extern "C" void FuseKernelCU(cudaStream_t stream, uint64_t resize_h, uint64_t resize_w, uint64_t crop_h, uint64_t crop_w, int32_t crop_top, int32_t crop_left, float norm_mean_0, float norm_mean_1, float norm_mean_2, float norm_std_0, float norm_std_1, float norm_std_2, uint64_t pad_h, uint64_t pad_w, int32_t pad_top, int32_t pad_left, int32_t pad_bottom, int32_t pad_right, float pad_value, uint8_t* __restrict__ src_raw_data, float* __restrict__ dst_raw_data, uint64_t dst_h, uint64_t dst_w, uint64_t src_h, uint64_t src_w, const char *format, const char *interpolation = "nearest"){
+    check_image_size(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, src_h, src_w);
 
     if (resize_h && resize_w && EQUAL(interpolation, "nearest")) {
         if(EQUAL(format, "BGR")){
@@ -419,6 +1075,181 @@ static constexpr const char *cuda_bilinear_func = R"(
       }
     })";
 
+/* with a CropResizeBatch op, FuseKernelBatch resizes every box of the frame
+   by the nearest or bilinear kernels. The tables of the box size are offset
+   to the box, so the kernels read the frame in place */
+static constexpr const char *cpu_batch_func_begin = R"(
+
+static void offset_table(int* __restrict__ tab, uint64_t n, int32_t offset) {
+  for (uint64_t i = 0; i < n; ++i) tab[i] += offset;
+}
+
+static bool crop_resize_box(uint64_t resize_h, uint64_t resize_w, uint64_t crop_h, uint64_t crop_w, int32_t crop_top, int32_t crop_left, float norm_mean_0, float norm_mean_1, float norm_mean_2, float norm_std_0, float norm_std_1, float norm_std_2, uint64_t pad_h, uint64_t pad_w, int32_t pad_top, int32_t pad_left, int32_t pad_bottom, int32_t pad_right, float pad_value, const int32_t* box, uint8_t* __restrict__ src_raw_data, dst_t* __restrict__ dst_raw_data, uint64_t src_h, uint64_t src_w, const char *format, const char *interpolation){
+    // the box is {left, top, width, height}, clipped to the frame
+    int64_t left = box[0] > 0 ? box[0] : 0;
+    int64_t top = box[1] > 0 ? box[1] : 0;
+    int64_t right = (int64_t)box[0] + box[2] < (int64_t)src_w ? (int64_t)box[0] + box[2] : (int64_t)src_w;
+    int64_t bottom = (int64_t)box[1] + box[3] < (int64_t)src_h ? (int64_t)box[1] + box[3] : (int64_t)src_h;
+    // nothing of the box is in the frame, the caller fills its output
+    if (right <= left || bottom <= top) return false;
+    uint64_t box_h = bottom - top;
+    uint64_t box_w = right - left;
+
+    if (EQUAL(interpolation, "nearest")) {
+        int* nearh = new int[resize_h];
+        int* nearw = new int[resize_w];
+
+        nearest_resize_preprocess(box_h, resize_h, nearh);
+        nearest_resize_preprocess(box_w, resize_w, nearw);
+        offset_table(nearh, resize_h, top);
+        offset_table(nearw, resize_w, left);
+
+        if(EQUAL(format, "BGR")){
+          BGR_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Nearest_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, nearh, nearw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+
+        delete[] nearh;
+        delete[] nearw;
+    } )";
+
+static constexpr const char *cpu_batch_bilinear_func = R"(
+    else if(EQUAL(interpolation, "bilinear")){
+        int* inth = new int[resize_h*2];
+        int* intw = new int[resize_w*2];
+
+        if(EQUAL(format, "NV12") || EQUAL(format, "NV21")) {
+          float* cubfh = new float[resize_h*2];
+          float* cubfw = new float[resize_w*2];
+
+          bilinear_float_resize_preprocess(box_h, box_w, resize_h, resize_w, cubfh, cubfw, inth, intw);
+          offset_table(inth, resize_h*2, top);
+          offset_table(intw, resize_w*2, left);
+
+          if(EQUAL(format, "NV12")){
+            NV12_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+          } else if(EQUAL(format, "NV21")){
+            NV21_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+          } else {
+            ABORT("This format is not supported");
+          }
+
+          delete[] cubfh;
+          delete[] cubfw;
+        } else {
+          short* cubfh = new short[resize_h*2];
+          short* cubfw = new short[resize_w*2];
+
+          bilinear_resize_preprocess(box_h, box_w, resize_h, resize_w, cubfh, cubfw, inth, intw);
+          offset_table(inth, resize_h*2, top);
+          offset_table(intw, resize_w*2, left);
+          int* rowh = new int[resize_h*2];
+          int* sloth = new int[resize_h*2];
+          uint64_t row_n = bilinear_resize_rows(src_h, resize_h, inth, rowh, sloth);
+          int* bilinear_rows = new int[row_n*resize_w*4];
+
+          if(EQUAL(format, "BGR")){
+            BGR_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, row_n, rowh, sloth, intw, cubfh, cubfw, bilinear_rows, src_raw_data, dst_raw_data, src_h, src_w);
+          } else if(EQUAL(format, "RGB")){
+            RGB_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, row_n, rowh, sloth, intw, cubfh, cubfw, bilinear_rows, src_raw_data, dst_raw_data, src_h, src_w);
+          } else if(EQUAL(format, "GRAY")){
+            GRAY_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, row_n, rowh, sloth, intw, cubfh, cubfw, bilinear_rows, src_raw_data, dst_raw_data, src_h, src_w);
+          } else if(EQUAL(format, "BGRA")){
+            BGRA_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, row_n, rowh, sloth, intw, cubfh, cubfw, bilinear_rows, src_raw_data, dst_raw_data, src_h, src_w);
+          } else {
+            ABORT("This format is not supported");
+          }
+
+          delete[] cubfh;
+          delete[] cubfw;
+          delete[] rowh;
+          delete[] sloth;
+          delete[] bilinear_rows;
+        }
+
+        delete[] inth;
+        delete[] intw;
+    })";
+
+static constexpr const char *cpu_batch_bilinear_float_func = R"(
+    else if(EQUAL(interpolation, "bilinear")){
+        int* inth = new int[resize_h*2];
+        int* intw = new int[resize_w*2];
+        float* cubfh = new float[resize_h*2];
+        float* cubfw = new float[resize_w*2];
+
+        bilinear_float_resize_preprocess(box_h, box_w, resize_h, resize_w, cubfh, cubfw, inth, intw);
+        offset_table(inth, resize_h*2, top);
+        offset_table(intw, resize_w*2, left);
+
+        if(EQUAL(format, "BGR")){
+          BGR_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "RGB")){
+          RGB_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "GRAY")){
+          GRAY_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "BGRA")){
+          BGRA_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV12")){
+          NV12_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else if(EQUAL(format, "NV21")){
+          NV21_Bilinear_Kernel(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, inth, intw, cubfh, cubfw, src_raw_data, dst_raw_data, src_h, src_w);
+        } else {
+          ABORT("This format is not supported");
+        }
+
+        delete[] cubfh;
+        delete[] cubfw;
+        delete[] inth;
+        delete[] intw;
+    })";
+
+/* the boxes are independent, each thread resizes whole boxes into its slice
+   of the N x ... output; batch_output_size is generated with the op list.
+   A box outside of the frame gets a zero slice and is counted in the
+   result, so that one bad box does not abort the whole batch.  format and
+   interpolation are checked before the boxes are */
+static constexpr const char *cpu_batch_func_end = R"(
+    else {
+      ABORT("This interpolation is not supported");
+    }
+    return true;
+}
+
+extern "C" uint64_t FuseKernelBatch(uint64_t resize_h, uint64_t resize_w, uint64_t crop_h, uint64_t crop_w, int32_t crop_top, int32_t crop_left, float norm_mean_0, float norm_mean_1, float norm_mean_2, float norm_std_0, float norm_std_1, float norm_std_2, uint64_t pad_h, uint64_t pad_w, int32_t pad_top, int32_t pad_left, int32_t pad_bottom, int32_t pad_right, float pad_value, const int32_t* boxes, uint64_t num_boxes, uint8_t* __restrict__ src_raw_data, dst_t* __restrict__ dst_raw_data, uint64_t src_h, uint64_t src_w, const char *format, const char *interpolation = "bilinear"){
+    // checked once here, so that the boxes never abort inside the parallel loop
+    check_image_size(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, src_h, src_w);
+    if (!EQUAL(format, "BGR") && !EQUAL(format, "RGB") && !EQUAL(format, "GRAY") &&
+        !EQUAL(format, "BGRA") && !EQUAL(format, "NV12") && !EQUAL(format, "NV21")) {
+      ABORT("This format is not supported");
+    }
+    if (!EQUAL(interpolation, "nearest") && !EQUAL(interpolation, "bilinear")) {
+      ABORT("This interpolation is not supported");
+    }
+    uint64_t stride = batch_output_size(resize_h, resize_w, crop_h, crop_w, pad_h, pad_w, format);
+    uint64_t outside = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:outside)
+    for (int64_t n = 0; n < (int64_t)num_boxes; ++n) {
+        if (!crop_resize_box(resize_h, resize_w, crop_h, crop_w, crop_top, crop_left, norm_mean_0, norm_mean_1, norm_mean_2, norm_std_0, norm_std_1, norm_std_2, pad_h, pad_w, pad_top, pad_left, pad_bottom, pad_right, pad_value, boxes + 4 * n, src_raw_data, dst_raw_data + n * stride, src_h, src_w, format, interpolation)) {
+          memset(dst_raw_data + n * stride, 0, stride * sizeof(dst_t));
+          ++outside;
+        }
+    }
+    return outside;
+}
+)";
+
 /* Common func end */
 static constexpr const char *call_func_end = R"(
     else {
@@ -0,0 +1,114 @@
+#include <iostream>
+
+#include "api.h"
+
+using namespace ir;
+
+namespace Warp {
+
+/// The source coordinates of output pixel (i, j) under the inverse affine
+/// matrix of warp_affine_preprocess: 'warph' holds the part depending on the
+/// row, 'warpw' the part depending on the column, so every row steps its
+/// base coordinate by a table entry per column.
+void SourceCoord(ir::Array<ir::IterVar> iter_vars, ir::TensorVarPtr warph,
+                 ir::TensorVarPtr warpw, ir::ExprPtr &sx, ir::ExprPtr &sy) {
+  auto zero = api::constant<uint64_t>(0);
+  auto one = api::constant<uint64_t>(1);
+  sx = (*warph)(zero, iter_vars[0]) + (*warpw)(zero, iter_vars[1]);
+  sy = (*warph)(one, iter_vars[0]) + (*warpw)(one, iter_vars[1]);
+}
+
+/// Source pixel (y, x), or 'border' outside of the image.  The load is
+/// clamped to the image, so it stays in bounds when it is not selected.
+ir::ExprPtr BorderPixel(ir::TensorVarPtr input, ir::ExprPtr y, ir::ExprPtr x,
+                        ir::ExprPtr k, ir::ExprPtr border) {
+  auto zero = api::constant<int32_t>(0);
+  auto one = api::constant<int32_t>(1);
+  auto src_h = cast(input->shape->element[0], ir::ScalarType::Int32);
+  auto src_w = cast(input->shape->element[1], ir::ScalarType::Int32);
+
+  std::vector<ir::ExprPtr> condition;
+  condition.push_back(api::logical::ge(y, zero));
+  condition.push_back(api::logical::lt(y, src_h));
+  condition.push_back(api::logical::ge(x, zero));
+  condition.push_back(api::logical::lt(x, src_w));
+
+  auto pixel = (*input)(min(max(y, zero), src_h - one),
+                        min(max(x, zero), src_w - one), k);
+  if (pixel->get_dtype() != border->get_dtype())
+    pixel = cast(pixel, border->get_dtype());
+  return api::if_then_else(api::logical::all(condition), pixel, border);
+}
+
+/// Source coordinate of OpenCV's INTER_NEAREST warp for the row part 'base'
+/// and the column part 'step': both are rounded to AB_BITS = 10 fractional
+/// bits, and their sum is rounded half up by adding round_delta =
+/// AB_SCALE / 2 before the shift.  The fixed-point sum is exact in float
+/// for coordinates below 2^14, and floor is the arithmetic shift.
+ir::ExprPtr NearestCoord(ir::ExprPtr base, ir::ExprPtr step) {
+  auto ab_scale = api::constant<float>(1024);
+  auto fixed = round(base * ab_scale) + round(step * ab_scale) +
+               api::constant<float>(512);
+  return cast(floor(fixed / ab_scale), ir::ScalarType::Int32);
+}
+
+/// Nearest affine sampling (OpenCV's warpAffine with INTER_NEAREST and
+/// BORDER_CONSTANT): the source coordinates are computed as NearestCoord,
+/// pixels mapped outside of the image take pad_value.
+ir::TensorVarPtr AffineNearest(const std::vector<ir::ExprPtr> &shape,
+                               ir::Array<ir::IterVar> iter_vars,
+                               ir::TensorVarPtr input, ir::TensorVarPtr warph,
+                               ir::TensorVarPtr warpw, ir::ExprPtr pad_value,
+                               const std::string &name = "WarpNearest") {
+  ELENA_ASSERT(shape.size() == input->shape->size(), "WarpNearest");
+
+  auto zero = api::constant<uint64_t>(0);
+  auto one = api::constant<uint64_t>(1);
+  auto sx = NearestCoord((*warph)(zero, iter_vars[0]),
+                         (*warpw)(zero, iter_vars[1]));
+  auto sy = NearestCoord((*warph)(one, iter_vars[0]),
+                         (*warpw)(one, iter_vars[1]));
+  return api::compute(
+      shape, iter_vars,
+      BorderPixel(input, sy, sx, iter_vars[2],
+                  cast(pad_value, input->get_dtype())),
+      name);
+}
+
+/// Bilinear affine sampling (OpenCV's warpAffine with INTER_LINEAR and
+/// BORDER_CONSTANT), computed in float: both rows are blended horizontally,
+/// then the two rows vertically.  Each of the 4 taps outside of the image
+/// takes pad_value, uint8 results are rounded half to even and saturated.
+/// The taps are sampled by the runtime's 'warp_bilinear', which skips the
+/// border tests when all of them are inside, as for nearly every pixel.
+ir::TensorVarPtr AffineBilinear(const std::vector<ir::ExprPtr> &shape,
+                                ir::Array<ir::IterVar> iter_vars,
+                                ir::TensorVarPtr input, ir::TensorVarPtr warph,
+                                ir::TensorVarPtr warpw, ir::ExprPtr pad_value,
+                                const std::string &name = "WarpBilinear") {
+  ELENA_ASSERT(shape.size() == input->shape->size(), "WarpBilinear");
+
+  ir::ExprPtr sx, sy;
+  SourceCoord(iter_vars, warph, warpw, sx, sy);
+  auto tap = api::construct_indices(
+      {input->shape->element[0], input->shape->element[1]});
+  std::vector<ir::ExprPtr> args{
+      (*input)(tap[0], tap[1], iter_vars[2]),
+      tap[0],
+      tap[1],
+      sx,
+      sy,
+      cast(input->shape->element[0], ir::ScalarType::Int32),
+      cast(input->shape->element[1], ir::ScalarType::Int32),
+      cast(pad_value, ir::ScalarType::Float32)};
+  auto value = std::make_shared<ir::Call>(
+      ir::CallFunction::warp_bilinear,
+      std::make_shared<ir::Array<ir::Expr>>(args), input->get_dtype());
+
+  // a Call as the whole fcompute would be evaluated for its side effects only.
+  return api::compute(shape, iter_vars,
+                      std::make_shared<ir::Cast>(value, input->get_dtype()),
+                      name);
+}
+
+}  // namespace Warp
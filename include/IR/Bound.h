@@ -21,9 +21,11 @@ using umap_iv_intset = std::unordered_map<ir::IterVarPtr, IntSetPtr>;
  * @param rmap bound for each known iteration
  */
 void inferRootBound(
-    const ir::StagePtr stage, ir::TensorVarMap<ir::ArrayPtr<ir::Op>> feed_graph,
-    std::unordered_map<ir::OpPtr, ir::StagePtr> op2stage,
-    std::unordered_map<ir::OpPtr, std::vector<ir::IterVarPtr>> attach_path,
+    const ir::StagePtr stage,
+    const ir::TensorVarMap<ir::ArrayPtr<ir::Op>>& feed_graph,
+    const std::unordered_map<ir::OpPtr, ir::StagePtr>& op2stage,
+    const std::unordered_map<ir::OpPtr, std::vector<ir::IterVarPtr>>&
+        attach_path,
     ir::MapPtr<ir::IterVar, ir::Range> rmap);
 
 /**
@@ -223,6 +223,11 @@ class Call : public Expr, public std::enable_shared_from_this<Call> {
   static constexpr IRNodeType type = IRNodeType::Call;
   explicit Call(CallFunction func, ArrayPtr<Expr> args, ScalarType dtype);
 
+  /// How the callee takes args[i].  Passes that look into the arguments
+  /// must not treat a Binder as a free variable, nor a Body or an Address
+  /// as a value computed once per call.
+  CallArgType arg_type(size_t i) const;
+
   CallFunction func;
   ArrayPtr<Expr> args;
 };
@@ -562,7 +567,9 @@ class IterVar : public NamedVar, public std::enable_shared_from_this<IterVar> {
 
   RangePtr range;
 
-  IterAttrType iter_type;
+  IterAttrType iter_type = IterAttrType::Data;
+  // unroll-by-N hint of an Unrolled iteration, 0 to unroll fully.
+  uint64_t unroll_factor = 0;
   std::string thread_tag;
   bool is_reduce;
   // always make use of all itervar range no matter of its comsumers' range
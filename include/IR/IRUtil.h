@@ -20,11 +20,10 @@ using ir::StmtPtr;
 StmtPtr mergeNest(std::vector<StmtPtr> nest, StmtPtr body);
 StmtPtr mergeNest(StmtPtr nest, StmtPtr body);
 
-IntSetPtr expr2IntSet(ExprPtr expr,
-                      std::unordered_map<ir::IterVarPtr, IntSetPtr> up_state_);
+IntSetPtr expr2IntSet(const ExprPtr& expr, const Rmap& up_state_);
 
 void propBoundToInputs(
-    ExprPtr expr, std::unordered_map<ir::IterVarPtr, IntSetPtr>* up_state,
+    const ExprPtr& expr, const Rmap& up_state,
     ir::TensorVarMap<std::vector<std::vector<IntSetPtr>>>* tmap);
 
 #endif  // ELENA_INCLUDE_IR_IRUTIL_H_
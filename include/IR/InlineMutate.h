@@ -83,6 +83,21 @@ class ExprReConstructor final : public VisitorBase<ExprReConstructor> {
         scalar_ptr->get_name()));
   }
 
+  void visit(ir::Call* call_ptr) {
+    if (!call_ptr->args) {
+      result = call_ptr->shared_from_this();
+      return;
+    }
+    std::vector<ir::ExprPtr> args;
+    for (auto& arg : call_ptr->args->element) {
+      visit(arg.get());
+      args.push_back(result);
+    }
+    result = std::make_shared<ir::Call>(
+        call_ptr->func, std::make_shared<ir::Array<ir::Expr>>(args),
+        call_ptr->get_dtype());
+  }
+
   void visit(ir::IterVar* iter_ptr) { result = iter_ptr->shared_from_this(); }
 
   ExprPtr getConstructedExpr(const ir::NodePtr& node) {
@@ -261,6 +261,13 @@ class Stage : public Node, public std::enable_shared_from_this<Stage> {
    * @param iter the iteration to be unrolled
    */
   StagePtr unroll(IterVarPtr iter);
+  /**
+   * @brief unroll a iteration by a factor, leaving a remainder loop; the
+   * extent may be symbolic
+   * @param iter the iteration to be unrolled
+   * @param factor the number of iterations per unrolled body
+   */
+  StagePtr unroll(IterVarPtr iter, uint64_t factor);
   /**
    * @brief parallel a iteration
    * @author lichuandong
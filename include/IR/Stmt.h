@@ -170,7 +170,7 @@ class For : public Stmt, public std::enable_shared_from_this<For> {
   /// loop times of the loop
   ExprPtr extent;
   /// loop type
-  ForType for_type;
+  ForType for_type{ForType::Serial};
   /// loop body
   StmtPtr body;
 };
@@ -50,6 +50,17 @@ static const char * const CallFunctionName[] = {
 };
 #define CALL_FUNCTION_NAME(x) (::ir::CallFunctionName[static_cast<int>(x)])
 
+/**
+ * @brief How the callee of a Call takes one of its arguments
+ *
+ */
+enum class CallArgType : int {
+  Value,    // evaluated once, before the call
+  Address,  // passed by address, the callee may read or write around it
+  Binder,   // an IterVar bound by the callee, a parameter of its lambda
+  Body,     // evaluated by the callee for every value of its Binder args
+};
+
 /**
  * @brief Type for Binary node
  * @author guanzhichao
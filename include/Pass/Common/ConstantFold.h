@@ -0,0 +1,38 @@
+#ifndef ELENA_INCLUDE_PASS_COMMON_CONSTANTFOLD_H_
+#define ELENA_INCLUDE_PASS_COMMON_CONSTANTFOLD_H_
+
+#include "IR/Expr.h"
+#include "IR/MutatorBase.h"
+#include "IR/Stmt.h"
+#include "IR/Type.h"
+
+/// Folds integer arithmetic, comparisons and conditions whose operands are
+/// constants, and the integer identities 'x + 0', 'x - 0', 'x * 1' and
+/// 'x * 0'.  Unlike 'api::simplify' it never reorders or re-types an
+/// expression, it only replaces a node by its constant value or, for a
+/// Select or IfThenElse with a constant condition, by the taken branch.
+///
+/// Mostly useful after unrolling, where selects on the loop variable such as
+/// 'c == 0 ? mean_0 : (c == 1 ? mean_1 : mean_2)' become constant.
+///
+/// Typical Usage:
+/// \code
+///   stmt = api::unrollPartial(stmt);
+///   stmt = api::foldConstants(stmt);
+/// \encode
+class ConstantFolder : public MutatorBase<ConstantFolder> {
+ public:
+  using MutatorBase::visit;
+  ir::NodePtr visit(ir::Binary* node);
+  ir::NodePtr visit(ir::Logical* node);
+  ir::NodePtr visit(ir::Select* node);
+  ir::NodePtr visit(ir::IfThenElse* node);
+  // tensors are shared with the schedule, leave their ops alone.
+  ir::NodePtr visit(ir::TensorVar* node) { return node->shared_from_this(); }
+};
+
+namespace api {
+ir::StmtPtr foldConstants(ir::StmtPtr stmt);
+}  // namespace api
+
+#endif  // ELENA_INCLUDE_PASS_COMMON_CONSTANTFOLD_H_
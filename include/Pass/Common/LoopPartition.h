@@ -0,0 +1,47 @@
+#ifndef ELENA_INCLUDE_PASS_COMMON_LOOPPARTITION_H_
+#define ELENA_INCLUDE_PASS_COMMON_LOOPPARTITION_H_
+
+#include "IR/Expr.h"
+#include "IR/MutatorBase.h"
+#include "IR/Stmt.h"
+#include "IR/Type.h"
+
+/// Splits a loop whose body selects on an interval of the loop variable, as
+/// a padded image does for its border, into the iterations before, inside
+/// and after the interval.  A select
+///
+///   cond && it >= lo && it < hi ? then : else
+///
+/// becomes 'else' in the first and the last part and 'cond ? then : else'
+/// in the middle one, so the interior no longer tests its position and the
+/// border is a plain fill.  Outer loops are split first: the border rows of
+/// an image then keep a single column loop, its interior rows get their own
+/// column split.
+///
+/// The bounds must be loop invariant and compared unsigned in their own
+/// type.  They are clamped to the loop range once before the parts (as Let
+/// variables), so any bounds are handled, also empty or inverted intervals.
+/// Every select of the body with the same interval is rewritten, others are
+/// kept in all three parts.
+///
+/// The bounds checks 'if (it < init + extent)' that scheduling leaves in the
+/// body hold in every part, they are removed from every loop visited, split
+/// or not.
+///
+/// Typical Usage:
+/// \code
+///   stmt = api::partitionLoops(stmt);
+/// \encode
+class LoopPartitioner : public MutatorBase<LoopPartitioner> {
+ public:
+  using MutatorBase::visit;
+  ir::NodePtr visit(ir::For* node);
+  // tensors are shared with the schedule, leave their ops alone.
+  ir::NodePtr visit(ir::TensorVar* node) { return node->shared_from_this(); }
+};
+
+namespace api {
+ir::StmtPtr partitionLoops(ir::StmtPtr stmt);
+}  // namespace api
+
+#endif  // ELENA_INCLUDE_PASS_COMMON_LOOPPARTITION_H_
@@ -0,0 +1,93 @@
+#ifndef ELENA_INCLUDE_PASS_COMMON_NARROWINDEX_H_
+#define ELENA_INCLUDE_PASS_COMMON_NARROWINDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "IR/Expr.h"
+#include "IR/MutatorBase.h"
+#include "IR/Stmt.h"
+#include "IR/Type.h"
+
+/// Rewrites loop iterators and index arithmetic to 32-bit unsigned where the
+/// value provably fits.  Ranges are computed bottom-up from constants, loop
+/// bounds, thread extents and the declared maxima of the kernel arguments
+/// ('var_max', keyed by name, e.g. the largest supported image size).
+///
+/// '+', '-' and '*' are evaluated modulo 2^32 once narrowed, so only the
+/// final index needs to fit; '/', '%', min/max, shifts and comparisons need
+/// every operand to fit.  A tensor access is in bounds by contract, so an
+/// index into a tensor with fewer than 2^32 elements is narrowed even when
+/// its operands (e.g. indices read from a table) are unbounded.  Narrowed
+/// iterators used by the remaining 64-bit code are cast back.
+///
+/// Typical Usage:
+/// \code
+///   stmt = api::narrowIndex(stmt, {{"h", 16384}, {"w", 16384}});
+/// \encode
+class IndexNarrower : public MutatorBase<IndexNarrower> {
+ public:
+  using Int = __int128;
+  struct Interval {
+    Int lo, hi;
+  };
+
+  explicit IndexNarrower(
+      const std::unordered_map<std::string, uint64_t>& var_max);
+
+  using MutatorBase::visit;
+  ir::NodePtr visit(ir::For* node);
+  ir::NodePtr visit(ir::Let* node);
+  ir::NodePtr visit(ir::Attr* node);
+  ir::NodePtr visit(ir::Store* node);
+  ir::NodePtr visit(ir::Logical* node);
+  ir::NodePtr visit(ir::ScalarVar* node);
+  ir::NodePtr visit(ir::IterVar* node);
+  // tensors are shared with the schedule, leave their ops alone.
+  ir::NodePtr visit(ir::TensorVar* node) { return node->shared_from_this(); }
+
+ private:
+  struct Info {
+    Interval range;
+    // type of the expression as the generated C code computes it.
+    ir::ScalarType ctype;
+  };
+
+  Info info(const ir::ExprPtr& expr);
+  Info compute(const ir::ExprPtr& expr);
+  /// The range of the computed value, i.e. clamped to its type on overflow.
+  Interval value(const ir::ExprPtr& expr);
+  /// Range of a floating point 'lhs op rhs', bounded only while every value
+  /// involved is an integer a float represents exactly.
+  Interval floatRange(ir::BinaryType op, const ir::BinaryPtr& binary);
+
+  /// A 32-bit version of 'expr', or nullptr.  With 'exact' the result equals
+  /// the original value, otherwise it is only congruent modulo 2^32.
+  ir::ExprPtr narrow(const ir::ExprPtr& expr, bool exact);
+  ir::ExprPtr narrowUncached(const ir::ExprPtr& expr, bool exact);
+  /// Narrows an access into a dimension holding 'extent' elements at most.
+  ir::ExprPtr narrowIndex(const ir::ExprPtr& index, Int extent);
+  /// Upper bound of the number of elements the i-th of 'count' indices of
+  /// 'tensor' addresses.
+  Int extentOf(const ir::TensorVarPtr& tensor, size_t count, size_t i);
+  ir::ExprPtr opaque(const ir::ExprPtr& expr);
+
+  std::unordered_map<std::string, uint64_t> var_max_;
+  // ranges of loop, let and thread variables.
+  std::unordered_map<const ir::Node*, Interval> bound_;
+  // narrowed iterator -> its 32-bit replacement.
+  std::unordered_map<const ir::Node*, ir::IterVarPtr> replace_;
+  std::unordered_map<ir::ExprPtr, Info> cache_;
+  // results of 'narrow', non-exact and exact.
+  std::unordered_map<ir::ExprPtr, ir::ExprPtr> narrowed_[2];
+  std::unordered_set<ir::NodePtr> seen_;
+};
+
+namespace api {
+ir::StmtPtr narrowIndex(
+    ir::StmtPtr stmt, const std::unordered_map<std::string, uint64_t>& var_max);
+}  // namespace api
+
+#endif  // ELENA_INCLUDE_PASS_COMMON_NARROWINDEX_H_
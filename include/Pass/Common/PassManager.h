@@ -0,0 +1,120 @@
+#ifndef ELENA_INCLUDE_PASS_COMMON_PASSMANAGER_H_
+#define ELENA_INCLUDE_PASS_COMMON_PASSMANAGER_H_
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "IR/Expr.h"
+#include "IR/Type.h"
+#include "api.h"
+
+/**
+ * @brief State threaded through a lowering pipeline.  Passes running before
+ * 'scheduleToStatement' work on the schedule, the others rewrite 'stmt'.
+ */
+struct LoweringContext {
+  ir::SchedulePtr schedule;
+  ir::MapPtr<ir::IterVar, ir::Range> bound;
+  ir::StmtPtr stmt;
+  // declared maxima of integer kernel arguments, by name, for 'narrowIndex'.
+  std::unordered_map<std::string, uint64_t> var_max;
+  // whether 'vectorizeLoops' may turn loops into simd lane loops, only for
+  // the kernels printed as C.
+  bool vectorize = false;
+};
+
+/**
+ * @brief Measurements taken around a single pass invocation.
+ */
+struct PassStatistics {
+  std::string name;
+  // index of the pipeline run (one per lowered kernel).
+  int run;
+  double wall_ms;
+  // distinct IR nodes reachable from the stmt (or the schedule when no stmt
+  // has been built yet).
+  uint64_t nodes_before;
+  uint64_t nodes_after;
+  // peak resident set size of the process after the pass, in KiB.
+  int64_t peak_rss_kb;
+};
+
+/**
+ * @brief Runs a named, configurable lowering pipeline and records per-pass
+ * wall time, IR size and peak memory.
+ *
+ * Typical Usage:
+ * \code
+ *   PassManager pm;
+ *   pm.setPipeline("normalize,inferBound,scheduleToStatement,flattenStorage");
+ *   pm.enableStatistics(true);
+ *   LoweringContext ctx;
+ *   ctx.schedule = sch;
+ *   pm.run(&ctx);
+ *   pm.printSummary(std::cerr);
+ * \encode
+ */
+class PassManager {
+ public:
+  using PassFunc = std::function<void(LoweringContext*)>;
+
+  /// The pipeline OpFuse used to hard-code, plus 'unrollPartial' which only
+  /// touches loops scheduled with an unroll factor, 'foldConstants' which
+  /// cleans up the unrolled copies, 'narrowIndex', 'partitionLoops',
+  /// 'vectorizeLoops', 'replaceScalars', 'reduceInductionVars', a second
+  /// 'foldConstants' for the initial values of the induction variables, and
+  /// 'reduceDivMod'.
+  static const char* defaultPipeline();
+
+  /// Registers the builtin passes and installs the default pipeline.
+  PassManager();
+
+  /// Adds (or replaces) a named pass that can then be used in pipelines.
+  void registerPass(const std::string& name, PassFunc func);
+
+  /// Appends a registered pass to the pipeline, aborts on unknown names.
+  void addPass(const std::string& name);
+
+  /// Replaces the pipeline by a comma separated list of pass names.
+  void setPipeline(const std::string& pipeline);
+
+  const std::vector<std::string>& getPipeline() const { return pipeline_; }
+
+  /// Node counting walks the whole IR twice per pass, so it is opt-in.
+  void enableStatistics(bool enable) { collect_ = enable; }
+
+  /// Runs every pass of the pipeline on the given context.
+  void run(LoweringContext* ctx);
+
+  const std::vector<PassStatistics>& getStatistics() const { return stats_; }
+
+  /// Prints the statistics accumulated over all runs, grouped by pass.
+  void printSummary(std::ostream& os) const;
+
+ private:
+  std::unordered_map<std::string, PassFunc> registry_;
+  std::vector<std::string> pipeline_;
+  std::vector<PassStatistics> stats_;
+  bool collect_{false};
+  int runs_{0};
+};
+
+namespace api {
+/**
+ * @brief Counts distinct IR nodes reachable from the given node.
+ * @param node root of the IR tree.
+ */
+uint64_t countNodes(ir::NodePtr node);
+
+/**
+ * @brief Peak resident set size of the current process in KiB, or -1 if the
+ * platform does not report it.
+ */
+int64_t peakMemoryKB();
+}  // namespace api
+
+#endif  // ELENA_INCLUDE_PASS_COMMON_PASSMANAGER_H_
@@ -0,0 +1,51 @@
+#ifndef ELENA_INCLUDE_PASS_COMMON_SCALARREPLACE_H_
+#define ELENA_INCLUDE_PASS_COMMON_SCALARREPLACE_H_
+
+#include "IR/Expr.h"
+#include "IR/MutatorBase.h"
+#include "IR/Stmt.h"
+#include "IR/Type.h"
+
+/// Scalar replacement of the loads an innermost loop repeats across
+/// iterations.  With 's' the stride of an index per iteration, 'A[f(i) + s]'
+/// is 'A[f(i + 1)]': a chain of loads 'A[f(i)]', 'A[f(i) + s]', ... is kept in
+/// rotating registers, every iteration loads only the last element of the
+/// chain and shifts the others down at its end.  A load whose index does not
+/// depend on the loop variable is loaded once.
+///
+/// Registers are filled before the loop with the values its first iteration
+/// loads, under the same conditions, so no load is executed that the original
+/// loop would not execute.  For the same reason only loads evaluated by
+/// either all iterations or none are replaced, i.e. not in the else branch
+/// of a select nor under a condition that depends on the loop variable, from
+/// tensors the loop does not store to.  The exception is the pad guard
+/// 'row tests & column tests' of a select: a load that does not depend on
+/// the loop variable is filled under the row tests alone, the column tests
+/// only bounding the indices that do.
+///
+/// Consecutive stores of an iteration, e.g. the unrolled channels of a
+/// pixel, compute a value they have in common once: the first store that
+/// evaluates it writes it to a register the others read.  A gray pixel thus
+/// resizes once for its three channels.  Registers are one-element local
+/// arrays.
+///
+/// Typical Usage:
+/// \code
+///   stmt = api::replaceScalars(stmt);
+/// \encode
+class ScalarReplacer : public MutatorBase<ScalarReplacer> {
+ public:
+  using MutatorBase::visit;
+  ir::NodePtr visit(ir::For* node);
+  // tensors are shared with the schedule, leave their ops alone.
+  ir::NodePtr visit(ir::TensorVar* node) { return node->shared_from_this(); }
+
+ private:
+  int registers_{0};
+};
+
+namespace api {
+ir::StmtPtr replaceScalars(ir::StmtPtr stmt);
+}  // namespace api
+
+#endif  // ELENA_INCLUDE_PASS_COMMON_SCALARREPLACE_H_
@@ -115,4 +115,293 @@ class StmtCopy : public MutatorBase<StmtCopy> {
   ir::NodePtr stmt_copy(ir::NodePtr node) { return visit(node.get()); }
 };
 
+/// Substitute IterVars by name without touching the input statement.
+///
+/// Unlike StmtCopy followed by IRSubstitue, only the nodes on a path to a
+/// substituted IterVar are rebuilt (as shallow copies of the originals); every
+/// other subtree is shared with the input, so the N bodies produced when
+/// unrolling a loop only cost the nodes that actually differ.
+///
+/// The second form replaces arbitrary nodes, matched by identity, the same
+/// way.
+///
+/// Typical Usage:
+/// \code
+///   auto blk = StmtCowSubstitute(value_map).substitute(body);
+///   auto expr = StmtCowSubstitute({{load.get(), reg}}).substitute(value);
+/// \encode
+class StmtCowSubstitute : public MutatorBase<StmtCowSubstitute> {
+ public:
+  explicit StmtCowSubstitute(
+      const std::unordered_map<std::string, ir::ExprPtr> &smap)
+      : smap_(smap) {}
+  explicit StmtCowSubstitute(
+      const std::unordered_map<const ir::Node *, ir::NodePtr> &nmap)
+      : smap_(noVars()), nmap_(&nmap) {}
+  using MutatorBase::visit;
+
+  ir::NodePtr visit(ir::IterVar *node) {
+    auto it = smap_.find(node->get_name());
+    if (it != smap_.end()) return it->second;
+    return node->shared_from_this();
+  }
+
+  ir::NodePtr visit(ir::ScalarVar *node) {
+    if (node->is_placeholder()) return node->shared_from_this();
+    bool changed = false;
+    auto indices = fork(node->indices, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::ScalarVar>(*node);
+    res->indices = indices;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Binary *node) {
+    bool changed = false;
+    auto lhs = fork(node->lhs, &changed);
+    auto rhs = fork(node->rhs, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Binary>(*node);
+    res->lhs = lhs;
+    res->rhs = rhs;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Logical *node) {
+    bool changed = false;
+    auto lhs = fork(node->lhs, &changed);
+    auto rhs = fork(node->rhs, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Logical>(*node);
+    res->lhs = lhs;
+    res->rhs = rhs;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Unary *node) {
+    bool changed = false;
+    auto operand = fork(node->operand, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Unary>(*node);
+    res->operand = operand;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Cast *node) {
+    bool changed = false;
+    auto expr = fork(node->expr_, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Cast>(*node);
+    res->expr_ = expr;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Select *node) {
+    bool changed = false;
+    auto cond = fork(node->cond, &changed);
+    auto t_branch = fork(node->tBranch, &changed);
+    auto f_branch = fork(node->fBranch, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Select>(*node);
+    res->cond = cond;
+    res->tBranch = t_branch;
+    res->fBranch = f_branch;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Call *node) {
+    bool changed = false;
+    auto args = fork(node->args, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Call>(*node);
+    res->args = args;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::BroadcastSymbol *node) {
+    bool changed = false;
+    auto base = fork(node->base_, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::BroadcastSymbol>(*node);
+    res->base_ = base;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::VectorSymbol *node) {
+    bool changed = false;
+    auto base = fork(node->base_, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::VectorSymbol>(*node);
+    res->base_ = base;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Ramp *node) {
+    bool changed = false;
+    auto base = fork(node->base, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Ramp>(*node);
+    res->base = base;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Range *node) {
+    bool changed = false;
+    auto init = fork(node->init, &changed);
+    auto extent = fork(node->extent, &changed);
+    auto stride = fork(node->stride, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Range>(*node);
+    res->init = init;
+    res->extent = extent;
+    res->stride = stride;
+    return res;
+  }
+
+  template <typename T>
+  ir::NodePtr visit(ir::Array<T> *node) {
+    bool changed = false;
+    std::vector<std::shared_ptr<T>> element;
+    element.reserve(node->element.size());
+    for (auto &a : node->element) element.push_back(fork(a, &changed));
+    if (!changed) return node->shared_from_this();
+    return std::make_shared<ir::Array<T>>(element);
+  }
+
+  ir::NodePtr visit(ir::For *node) {
+    bool changed = false;
+    auto init = fork(node->init, &changed);
+    auto extent = fork(node->extent, &changed);
+    auto body = fork(node->body, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::For>(*node);
+    res->init = init;
+    res->extent = extent;
+    res->body = body;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Block *node) {
+    bool changed = false;
+    auto head = fork(node->head, &changed);
+    auto tail = fork(node->tail, &changed);
+    if (!changed) return node->shared_from_this();
+    return std::make_shared<ir::Block>(head, tail);
+  }
+
+  ir::NodePtr visit(ir::IfThenElse *node) {
+    bool changed = false;
+    auto condition = fork(node->condition, &changed);
+    auto then_case = fork(node->then_case, &changed);
+    auto else_case = fork(node->else_case, &changed);
+    if (!changed) return node->shared_from_this();
+    return std::make_shared<ir::IfThenElse>(condition, then_case, else_case);
+  }
+
+  ir::NodePtr visit(ir::Evaluate *node) {
+    bool changed = false;
+    auto value = fork(node->value, &changed);
+    if (!changed) return node->shared_from_this();
+    return std::make_shared<ir::Evaluate>(value);
+  }
+
+  ir::NodePtr visit(ir::Let *node) {
+    bool changed = false;
+    auto value = fork(node->value, &changed);
+    auto body = fork(node->body, &changed);
+    if (!changed) return node->shared_from_this();
+    return std::make_shared<ir::Let>(node->var, value, body);
+  }
+
+  ir::NodePtr visit(ir::Attr *node) {
+    bool changed = false;
+    auto value = fork(node->value, &changed);
+    auto body = fork(node->body, &changed);
+    if (!changed) return node->shared_from_this();
+    return std::make_shared<ir::Attr>(node->node, node->key, value, body);
+  }
+
+  ir::NodePtr visit(ir::Provide *node) {
+    bool changed = false;
+    auto value = fork(node->value, &changed);
+    auto index = fork(node->index, &changed);
+    if (!changed) return node->shared_from_this();
+    return std::make_shared<ir::Provide>(node->var, value, index);
+  }
+
+  ir::NodePtr visit(ir::Store *node) {
+    bool changed = false;
+    auto value = fork(node->value, &changed);
+    auto index = fork(node->index, &changed);
+    if (!changed) return node->shared_from_this();
+    return std::make_shared<ir::Store>(node->var, value, index);
+  }
+
+  ir::NodePtr visit(ir::Realize *node) {
+    bool changed = false;
+    auto bound = fork(node->bound, &changed);
+    auto body = fork(node->body, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Realize>(*node);
+    res->bound = bound;
+    res->body = body;
+    return res;
+  }
+
+  ir::NodePtr visit(ir::Allocate *node) {
+    bool changed = false;
+    auto bound = fork(node->bound, &changed);
+    auto body = fork(node->body, &changed);
+    if (!changed) return node->shared_from_this();
+    auto res = std::make_shared<ir::Allocate>(*node);
+    res->bound = bound;
+    res->body = body;
+    return res;
+  }
+
+  ir::StmtPtr substitute(const ir::StmtPtr &stmt) {
+    if ((smap_.empty() && !nmap_) || !stmt) return stmt;
+    bool changed = false;
+    return fork(stmt, &changed);
+  }
+
+  ir::ExprPtr substitute(const ir::ExprPtr &expr) {
+    if ((smap_.empty() && !nmap_) || !expr) return expr;
+    bool changed = false;
+    return fork(expr, &changed);
+  }
+
+ private:
+  /// Visit a child once, keeping shared children shared in the result, and
+  /// record whether it had to be rebuilt.
+  template <typename T>
+  std::shared_ptr<T> fork(const std::shared_ptr<T> &child, bool *changed) {
+    if (!child) return child;
+    auto it = forked_.find(child.get());
+    ir::NodePtr res;
+    if (it != forked_.end()) {
+      res = it->second;
+    } else {
+      if (nmap_) {
+        auto replaced = nmap_->find(child.get());
+        if (replaced != nmap_->end()) res = replaced->second;
+      }
+      if (!res) res = visit(child.get());
+      forked_[child.get()] = res;
+    }
+    if (res == child) return child;
+    *changed = true;
+    return ir::ptr_cast<T>(res);
+  }
+
+  static const std::unordered_map<std::string, ir::ExprPtr> &noVars() {
+    static const std::unordered_map<std::string, ir::ExprPtr> empty;
+    return empty;
+  }
+
+  const std::unordered_map<std::string, ir::ExprPtr> &smap_;
+  const std::unordered_map<const ir::Node *, ir::NodePtr> *nmap_{nullptr};
+  std::unordered_map<ir::Node *, ir::NodePtr> forked_;
+};
+
 #endif  // ELENA_INCLUDE_PASS_COMMON_STMTCOPY_H_
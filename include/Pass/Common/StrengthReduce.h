@@ -0,0 +1,63 @@
+#ifndef ELENA_INCLUDE_PASS_COMMON_STRENGTHREDUCE_H_
+#define ELENA_INCLUDE_PASS_COMMON_STRENGTHREDUCE_H_
+
+#include <unordered_set>
+
+#include "IR/Expr.h"
+#include "IR/MutatorBase.h"
+#include "IR/Stmt.h"
+#include "IR/Type.h"
+
+/// Rewrites unsigned division and modulo by a constant.  A power of two
+/// becomes a shift or a mask, any other divisor a multiply-high with a magic
+/// number followed by a shift ('mulhi' call).  'x % d' is 'x - x / d * d'.
+///
+/// Signed and floating point operations are left alone, their rounding
+/// differs from a shift.
+///
+/// Typical Usage:
+/// \code
+///   stmt = api::reduceDivMod(stmt);
+/// \encode
+class DivModReducer : public MutatorBase<DivModReducer> {
+ public:
+  using MutatorBase::visit;
+  ir::NodePtr visit(ir::Binary* node);
+  // tensors are shared with the schedule, leave their ops alone.
+  ir::NodePtr visit(ir::TensorVar* node) { return node->shared_from_this(); }
+};
+
+/// Carries flattened indices that are affine in a loop variable across the
+/// iterations of that loop.  An index such as '(i * w + j) * c + k' is
+/// computed once before the loop into an offset and bumped by its constant
+/// (or loop invariant) stride at the end of every iteration, so the access
+/// itself costs a load of the offset instead of a multiply chain.
+///
+/// Inner loops are handled first; the initial value of their offsets is then
+/// affine in the enclosing loop variable and gets its own offset there.  Only
+/// unsigned indices whose every operand has the type of the loop variable
+/// are rewritten, the bumps then wrap exactly like the original arithmetic.
+/// The offsets are one-element local arrays.
+///
+/// Typical Usage:
+/// \code
+///   stmt = api::reduceInductionVars(stmt);
+/// \encode
+class InductionVarReducer : public MutatorBase<InductionVarReducer> {
+ public:
+  using MutatorBase::visit;
+  ir::NodePtr visit(ir::For* node);
+  // tensors are shared with the schedule, leave their ops alone.
+  ir::NodePtr visit(ir::TensorVar* node) { return node->shared_from_this(); }
+
+ private:
+  // offsets of the loops rewritten so far.
+  std::unordered_set<const ir::Node*> offsets_;
+};
+
+namespace api {
+ir::StmtPtr reduceDivMod(ir::StmtPtr stmt);
+ir::StmtPtr reduceInductionVars(ir::StmtPtr stmt);
+}  // namespace api
+
+#endif  // ELENA_INCLUDE_PASS_COMMON_STRENGTHREDUCE_H_
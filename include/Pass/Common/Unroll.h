@@ -24,7 +24,6 @@ class UnrollFuller : public MutatorBase<UnrollFuller> {
   ir::NodePtr visit(ir::For* node);
 
  private:
-  StmtCopy stmt_copyer;
   int offset = 1;
 };
 
@@ -40,8 +39,26 @@ class AutoUnroller : public MutatorBase<AutoUnroller> {
   bool is_full_unroll = false;
 };
 
+/// Unrolls the loops scheduled with 'unroll(iter, factor)' by 'factor'.
+/// The extent may be symbolic, the last 'extent % factor' iterations run in
+/// a remainder loop.  A constant extent of at most 'factor' is unrolled
+/// completely, every copy sees the loop variable as a constant.
+///
+/// Typical Usage:
+/// \code
+///   (*sch)[op]->unroll(iter_vars[1], 4);
+///   ...
+///   stmt = api::unrollPartial(stmt);
+/// \encode
+class PartialUnroller : public MutatorBase<PartialUnroller> {
+ public:
+  using MutatorBase::visit;
+  ir::NodePtr visit(ir::For* node);
+};
+
 namespace api {
 ir::StmtPtr unrollFull(ir::StmtPtr stmt);
+ir::StmtPtr unrollPartial(ir::StmtPtr stmt);
 ir::StmtPtr autoUnroll(ir::StmtPtr stmt, bool is_full_unroll);
 
 }  // namespace api
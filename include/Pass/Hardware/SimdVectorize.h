@@ -5,74 +5,62 @@
 #ifndef ELENA_INCLUDE_PASS_HARDWARE_SIMDVECTORIZE_H_
 #define ELENA_INCLUDE_PASS_HARDWARE_SIMDVECTORIZE_H_
 
-#include <utility>
-
+#include "IR/Expr.h"
 #include "IR/MutatorBase.h"
 #include "IR/Stmt.h"
-
-namespace ir {
-
-class Vectorizer : public MutatorBase<Vectorizer> {
+#include "IR/Type.h"
+
+/// Turns the innermost loops of the cpu kernels whose iterations are
+/// independent into lane loops the C compiler vectorizes.  The loop becomes
+/// 'for (int64_t lane = 0; lane < extent; ++lane)', marked 'Vectorized' and
+/// printed under '#pragma GCC ivdep', with the loop variable 'init + lane'.
+/// Whole fused bodies (arithmetic, casts, selects, pad tests) are vectorized
+/// by the compiler that way, none of them needs a vector IR node.  The
+/// pragma does not override the cost model of the compiler, unlike
+/// '#pragma omp simd', which vectorized the interleaved channels of a BGR
+/// kernel at -O2 into a loop four times slower.
+///
+/// An index that is affine in the loop variable with a constant stride 's'
+/// is rewritten as '(int64_t)(int32_t)index(init) + s * lane': the 32-bit
+/// unsigned arithmetic of 'narrowIndex' wraps, which keeps compilers from
+/// proving the accesses consecutive.  The base is read as signed since the
+/// first lane may be outside of a pad guard, with a negative index that
+/// wrapped; indices lie in (-2^31, 2^31) (see MAX_IMAGE_SIZE), so every lane
+/// gets its exact index.  The channel 'c < s' of an interleaved access is
+/// added after the cast, '(int64_t)(int32_t)(index(init) - c) + c + s * lane':
+/// the compiler then loads the channels of a pixel as one group instead of
+/// assembling each vector element by element, which made the loops of a BGR
+/// kernel four times slower with SSE2.
+///
+/// Iterations are independent when the body only stores, under conditions
+/// or not, to tensors it does not load, at indices affine in the loop
+/// variable with a nonzero stride, and calls no helper.  Nor may a load be
+/// under a condition that depends on the loop variable, as the pad test of
+/// a pad followed by a crop: the compiler cannot load for every lane, and the
+/// scalar loop keeps the loads of the row in registers.  A loop loading
+/// 8 or 16-bit elements that differ between lanes, such as the uint8 source
+/// of the color conversions and of the nearest and horizontal bilinear
+/// resize, is left alone: x86 has no gather of bytes, and widening the
+/// interleaved channels made GCC's vector loops slower than the scalar loop,
+/// which keeps the registers of 'replaceScalars'.  That leaves the vertical
+/// pass of the bilinear resize, the pad fills and the float stages.  Kernels
+/// running on a device (the body of a thread binding) are skipped.
+///
+/// Typical Usage:
+/// \code
+///   stmt = api::vectorizeLoops(stmt);
+/// \encode
+class LoopVectorizer : public MutatorBase<LoopVectorizer> {
  public:
-  Vectorizer(IterVarPtr loop_var, uint64_t extent)
-      : loop_var_(std::move(loop_var)), var_lanes_(extent) {}
-
   using MutatorBase::visit;
-
-  // basic structural op
-  StmtPtr visit(Store* op);
-  StmtPtr visit(IfThenElse* op);
-  StmtPtr visit(Let* op);
-  StmtPtr visit(Allocate* op);
-  ExprPtr visit(Call* op);
-  ExprPtr visit(Cast* op);
-
-  // basic arithmetic op
-  ExprPtr visit(Unary* op);
-  ExprPtr visit(Binary* op);
-  ExprPtr visit(Logical* op);
-
- private:
-  // vectorize binary op
-  //  template <typename TOp, typename T>
-  //  ExprPtr VectorizeBinary(const T* op);
-  template <typename T, typename FCompute>
-  ExprPtr vectorizeBinary(const T* op, FCompute fcompute,
-                          SymbolType lhs_symbol_type,
-                          SymbolType rhs_symbol_type);
-
-  struct BinaryTypeHash {
-    template <typename T>
-    std::size_t operator()(T t) const {
-      return static_cast<std::size_t>(t);
-    }
-  };
-
-  ExprPtr setLanes(ExprPtr e, SymbolType symbol_type) const;
-
-  // loop value, to be replaced
-  IterVarPtr loop_var_;
-  // the lanes, equal to the extent of 'for'
-  uint64_t var_lanes_;
+  ir::NodePtr visit(ir::For* node);
+  ir::NodePtr visit(ir::Attr* node);
+  // tensors are shared with the schedule, leave their ops alone.
+  ir::NodePtr visit(ir::TensorVar* node) { return node->shared_from_this(); }
 };
 
-class LoopVectorizer final : public MutatorBase<LoopVectorizer> {
- public:
-  LoopVectorizer() = default;
-
-  using MutatorBase::visit;
-
-  StmtPtr visit(For* op);
-};
-
-class LoopVectorizerSkipper : public MutatorBase<LoopVectorizerSkipper> {
- public:
-  LoopVectorizerSkipper() = default;
-
-  StmtPtr visit(For* op);
-
-  using MutatorBase::visit;
-};
+namespace api {
+ir::StmtPtr vectorizeLoops(ir::StmtPtr stmt);
+}  // namespace api
 
-}  // namespace ir
 #endif  // ELENA_INCLUDE_PASS_HARDWARE_SIMDVECTORIZE_H_
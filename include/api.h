@@ -31,7 +31,6 @@
 #include "Pass/Common/StorageFlatten.h"
 #include "Pass/Common/StorageRewrite.h"
 #include "Pass/Common/Unroll.h"
-#include "Pass/Common/VectorizeLoad.h"
 #include "Pass/Hardware/SimdVectorize.h"
 #include "Pass/Hardware/Tensorize.h"
 #include "Schedule/Schedule.h"
@@ -535,14 +534,6 @@ ir::StmtPtr flattenStorage(ir::StmtPtr stmt, MapPtr<IterVar, Range> bound);
 
 ir::StmtPtr rewriteStorage(ir::StmtPtr stmt);
 
-/**
- * @brief LoopVectorizer operation
- * @author mupei
- * @param stmt the root node ptr to be vectorize
- */
-ir::StmtPtr simdVectorizeLoop(ir::StmtPtr stmt,
-                              const bool enable_vectorize = true);
-
 /**
  * @brief Transforms a schedule to stmt
  * @author hanruobing
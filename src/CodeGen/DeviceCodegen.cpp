@@ -25,6 +25,19 @@ DeviceCodegen<DeviceType>::DeviceCodegen(
 
 template <typename DeviceType>
 void DeviceCodegen<DeviceType>::visit(ir::Cast *cast_ptr) {
+  // C has no half types, the cpu code stores their bits in uint16_t and
+  // converts with the helpers of elena_int.h.
+  if (std::is_same<DeviceType, CCode>::value &&
+      (cast_ptr->get_dtype() == ir::ScalarType::Float16 ||
+       cast_ptr->get_dtype() == ir::ScalarType::BFloat16)) {
+    *this << (cast_ptr->get_dtype() == ir::ScalarType::Float16
+                  ? "f32_to_f16"
+                  : "f32_to_bf16")
+          << "((float)(";
+    visit(cast_ptr->expr_);
+    *this << "))";
+    return;
+  }
   *this << '(' << TYPE_OF(cast_ptr) << ')';
   *this << '(';
   visit(cast_ptr->expr_);
@@ -213,6 +226,10 @@ void DeviceCodegen<DeviceType>::visit(ir::For *for_stmt_ptr) {
   if (for_stmt_ptr->it->iter_type == ir::IterAttrType::Unrolled) {
     *this << "#pragma unroll" << endl;
   }
+  if (std::is_same<DeviceType, CCode>::value &&
+      for_stmt_ptr->for_type == ir::ForType::Vectorized) {
+    *this << "#pragma GCC ivdep" << endl;
+  }
   *this << "for (" << TYPE_OF(for_stmt_ptr->it) << " ";
   visit(for_stmt_ptr->it);
   *this << " = ";
@@ -548,10 +565,10 @@ void DeviceCodegen<DeviceType>::visit(ir::Binary *binary_ptr) {
     visit(binary_ptr->rhs);
     *this << ")";
   } else if (binary_ptr->operation_type == BinaryType::Max) {
-    if (type == ScalarType::UInt64) {
-      *this << "max((uint64_t)";
+    if (type == ScalarType::UInt64 || type == ScalarType::UInt32) {
+      *this << "max((" << TYPE_OF(binary_ptr) << ")";
       visit(binary_ptr->lhs);
-      *this << ", (uint64_t)";
+      *this << ", (" << TYPE_OF(binary_ptr) << ")";
       visit(binary_ptr->rhs);
       *this << ")";
     } else if (type == ScalarType::Float16) {
@@ -581,10 +598,10 @@ void DeviceCodegen<DeviceType>::visit(ir::Binary *binary_ptr) {
       *this << ")";
     }
   } else if (binary_ptr->operation_type == BinaryType::Min) {
-    if (type == ScalarType::UInt64) {
-      *this << "min((uint64_t)";
+    if (type == ScalarType::UInt64 || type == ScalarType::UInt32) {
+      *this << "min((" << TYPE_OF(binary_ptr) << ")";
       visit(binary_ptr->lhs);
-      *this << ", (uint64_t)";
+      *this << ", (" << TYPE_OF(binary_ptr) << ")";
       visit(binary_ptr->rhs);
       *this << ")";
     } else if (type == ScalarType::Float16) {
@@ -680,6 +697,16 @@ void DeviceCodegen<DeviceType>::visit(ir::Binary *binary_ptr) {
     *this << ", ";
     visit(binary_ptr->rhs);
     *this << ")";
+  } else if ((binary_ptr->operation_type == BinaryType::Sll ||
+              binary_ptr->operation_type == BinaryType::Slr) &&
+             (type == ScalarType::UInt32 || type == ScalarType::UInt64)) {
+    // unsigned shifts keep their width, e.g. from the div/mod reduction.
+    *this << "((";
+    visit(binary_ptr->lhs);
+    *this << (binary_ptr->operation_type == BinaryType::Sll ? ") << ("
+                                                             : ") >> (");
+    visit(binary_ptr->rhs);
+    *this << "))";
   } else if (binary_ptr->operation_type == BinaryType::Sll) {
     *this << "((int)";
     visit(binary_ptr->lhs);
@@ -816,6 +843,66 @@ void DeviceCodegen<DeviceType>::visit(ir::Call *call_ptr) {
     *this << ", &";
     visit(call_ptr->args->element[7]);
     *this << ");";
+  } else if (call_ptr->func == CallFunction::mulhi &&
+             call_ptr->args->element.size() == 2) {
+    // High half of the unsigned product with a magic constant, for the
+    // division by constants.  The constant may not fit a signed literal.
+    bool is_64 = call_ptr->get_dtype() == ScalarType::UInt64;
+    auto magic = ptr_cast<Const<uint64_t>>(call_ptr->args->element[1]);
+    ELENA_ASSERT(magic, "mulhi expects a constant multiplier");
+    if (std::is_same<DeviceType, CudaCode>::value ||
+        std::is_same<DeviceType, TangCode>::value) {
+      *this << (is_64 ? "__umul64hi(" : "__umulhi(");
+      visit(call_ptr->args->element[0]);
+      *this << ", " << magic->get_value() << (is_64 ? "ull)" : "u)");
+    } else {
+      *this << (is_64 ? "(uint64_t)(((unsigned __int128)"
+                      : "(uint32_t)(((uint64_t)");
+      visit(call_ptr->args->element[0]);
+      *this << " * " << magic->get_value()
+            << (is_64 ? "ull) >> 64)" : "u) >> 32)");
+    }
+  } else if ((call_ptr->func == CallFunction::area_row ||
+              call_ptr->func == CallFunction::area_col ||
+              call_ptr->func == CallFunction::pil_row ||
+              call_ptr->func == CallFunction::pil_col) &&
+             call_ptr->args->element.size() == 5) {
+    // Weighted sum over a window of one axis, the first argument is the
+    // source pixel (or row) at the iterator passed as the second, which
+    // becomes the parameter of a lambda.
+    auto k = ptr_cast<IterVar>(call_ptr->args->element[1]);
+    ELENA_ASSERT(k, "window sums expect the window iterator");
+    *this << CALL_FUNCTION_NAME(call_ptr->func) << "([&](" << TYPE_OF(k)
+          << " ";
+    visit(k.get());
+    *this << ") { return ";
+    visit(call_ptr->args->element[0]);
+    *this << "; }, ";
+    visit(call_ptr->args->element[2]);
+    *this << ", ";
+    visit(call_ptr->args->element[3]);
+    *this << ", &";
+    visit(call_ptr->args->element[4]);
+    *this << ")";
+  } else if (call_ptr->func == CallFunction::warp_bilinear &&
+             call_ptr->args->element.size() == 8) {
+    // Bilinear sample at a source coordinate, the source pixel is passed as
+    // a lambda like for the window sums.
+    auto y = ptr_cast<IterVar>(call_ptr->args->element[1]);
+    auto x = ptr_cast<IterVar>(call_ptr->args->element[2]);
+    ELENA_ASSERT(y && x, "warp_bilinear expects the tap iterators");
+    *this << "warp_bilinear([&](" << TYPE_OF(y) << " ";
+    visit(y.get());
+    *this << ", " << TYPE_OF(x) << " ";
+    visit(x.get());
+    *this << ") { return ";
+    visit(call_ptr->args->element[0]);
+    *this << "; }";
+    for (size_t i = 3; i < 8; ++i) {
+      *this << ", ";
+      visit(call_ptr->args->element[i]);
+    }
+    *this << ")";
   } else if (call_ptr->func == CallFunction::atomic_add &&
              call_ptr->args->element.size() == 2) {
     *this << "atomicAdd(&";
@@ -1189,6 +1276,10 @@ std::string genX86Header() {
 #include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
+#if defined(__AVX512FP16__) || defined(__F16C__)
+#include <immintrin.h>
+#endif
 
 #define min(a,b) ((a)>(b)?(b):(a))
 #define max(a,b) ((a)>(b)?(a):(b))
@@ -1211,6 +1302,45 @@ std::string genX86Header() {
               : (x >= 0 ? (x - floorf(x) > 0.5 ? ceilf(x) : floorf(x)) \
                         : (ceilf(x) - x > 0.5 ? floorf(x) : ceilf(x))))
 #define reverse01(x, y) (x > 0 ? 1 : y)
+
+// float to IEEE half and bfloat16 bits, rounding to nearest even.
+static inline uint16_t f32_to_f16(float x) {
+#if defined(__AVX512FP16__)
+  _Float16 h = (_Float16)x;
+  uint16_t o;
+  memcpy(&o, &h, sizeof(o));
+  return o;
+#elif defined(__F16C__)
+  return _cvtss_sh(x, _MM_FROUND_TO_NEAREST_INT);
+#else
+  uint32_t f;
+  memcpy(&f, &x, sizeof(f));
+  uint32_t sign = (f >> 16) & 0x8000;
+  f &= 0x7fffffff;
+  uint32_t o;
+  if (f >= 0x47800000) {
+    // overflow to inf, nan stays a quiet nan
+    o = f > 0x7f800000 ? 0x7e00 : 0x7c00;
+  } else if (f < 0x38800000) {
+    // subnormal, the float addition of 0.5f rounds the mantissa
+    float v;
+    memcpy(&v, &f, sizeof(v));
+    v += 0.5f;
+    memcpy(&o, &v, sizeof(o));
+    o -= 0x3f000000;
+  } else {
+    o = (f + 0xc8000fff + ((f >> 13) & 1)) >> 13;
+  }
+  return (uint16_t)(o | sign);
+#endif
+}
+
+static inline uint16_t f32_to_bf16(float x) {
+  uint32_t f;
+  memcpy(&f, &x, sizeof(f));
+  if ((f & 0x7fffffff) > 0x7f800000) return (uint16_t)((f >> 16) | 0x40);
+  return (uint16_t)((f + 0x7fff + ((f >> 16) & 1)) >> 16);
+}
 )";
 }
 
@@ -1259,9 +1389,14 @@ static inline std::string genDeviceSrc(
   auto visit_arg_list = [&]() {
     auto visit_arg = [&](size_t i) {
       const char *str = SCALARTYPE_SYMBOL(arg_list[i].second);
-      str = strcmp(str, "wchar_t") == 0
-                ? "half"
-                : (strcmp(str, "uint16_t") == 0 ? "nv_bfloat16" : str);
+      if (std::is_same<DeviceType, CCode>::value) {
+        // half and bfloat16 tensors hold the bits as uint16_t on cpu.
+        str = strcmp(str, "wchar_t") == 0 ? "uint16_t" : str;
+      } else {
+        str = strcmp(str, "wchar_t") == 0
+                  ? "half"
+                  : (strcmp(str, "uint16_t") == 0 ? "nv_bfloat16" : str);
+      }
       visitor << str << "* __restrict__ Var" << arg_list[i].first;
     };
 
@@ -1332,9 +1467,14 @@ static inline std::string genDeviceSrc(const ir::NodePtr &node,
   auto visit_arg_list = [&]() {
     auto visit_arg = [&](size_t i) {
       const char *str = SCALARTYPE_SYMBOL(arg_list[i]->get_dtype());
-      str = strcmp(str, "wchar_t") == 0
-                ? "half"
-                : (strcmp(str, "uint16_t") == 0 ? "nv_bfloat16" : str);
+      if (std::is_same<DeviceType, CCode>::value) {
+        // half and bfloat16 tensors hold the bits as uint16_t on cpu.
+        str = strcmp(str, "wchar_t") == 0 ? "uint16_t" : str;
+      } else {
+        str = strcmp(str, "wchar_t") == 0
+                  ? "half"
+                  : (strcmp(str, "uint16_t") == 0 ? "nv_bfloat16" : str);
+      }
       if (arg_list[i]->get_type() == ir::IRNodeType::TensorVar) {
         auto var = ptr_cast<TensorVar>(arg_list[i]);
         visitor << str << "* __restrict__ " << var->get_name();
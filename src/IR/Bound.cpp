@@ -208,9 +208,11 @@ void updateRootBound(const ir::StagePtr stage, const ir::IterVarPtr iv,
 
 /// Update the range of IterVars for all the stages.
 void inferRootBound(
-    const ir::StagePtr stage, ir::TensorVarMap<ir::ArrayPtr<ir::Op>> feed_graph,
-    std::unordered_map<ir::OpPtr, ir::StagePtr> op2stage,
-    std::unordered_map<ir::OpPtr, std::vector<ir::IterVarPtr>> attach_path,
+    const ir::StagePtr stage,
+    const ir::TensorVarMap<ir::ArrayPtr<ir::Op>>& feed_graph,
+    const std::unordered_map<ir::OpPtr, ir::StagePtr>& op2stage,
+    const std::unordered_map<ir::OpPtr, std::vector<ir::IterVarPtr>>&
+        attach_path,
     ir::MapPtr<ir::IterVar, ir::Range> rmap) {
   ELENA_ASSERT_NE(stage->attach_type, ir::AttachType::Inline,
                   "call schedule.normalize before scheduleops");
@@ -273,9 +275,12 @@ void inferRootBound(
       updateRootBound(stage, iv, found_attach, rmap, up_state);
     }
 
-    for (const auto& iv : attach_path[op]) {
-      found_attach = (is_compute_at && (iv == attach_iter)) || found_attach;
-      updateRootBound(stage, iv, found_attach, rmap, up_state);
+    auto path = attach_path.find(op);
+    if (path != attach_path.end()) {
+      for (const auto& iv : path->second) {
+        found_attach = (is_compute_at && (iv == attach_iter)) || found_attach;
+        updateRootBound(stage, iv, found_attach, rmap, up_state);
+      }
     }
 
     passUpDomain(op_stage, &up_state, rmap);
@@ -285,16 +290,15 @@ void inferRootBound(
     // TODO(hanruobing): Relax if needed.
     if (op->get_type() == ir::IRNodeType::ComputeOp) {
       auto compute_op = ir::ptr_cast<ir::ComputeOp>(op);
-      propBoundToInputs(compute_op->fcompute, &up_state, &tmap);
+      propBoundToInputs(compute_op->fcompute, up_state, &tmap);
     }
   }
   ELENA_ASSERT_EQ(stage->op->output_count(), 1,
                   "Elena can only handle one output for a expr");
   auto compute_op = ir::ptr_cast<ir::ComputeOp>(stage->op);
-  auto IntSet_vector = tmap.at(compute_op->output(0));
-  auto output_tensor = compute_op->output(0);
+  auto& IntSet_vector = tmap.at(compute_op->output(0));
   for (size_t i = 0; i < compute_op->iter_vars->element.size(); i++) {
-    auto intset_list = tmap[output_tensor][i];
+    auto& intset_list = IntSet_vector[i];
     if (intset_list.empty()) {
       // use origin range if true (now especially for norm,
       // because it needs ptr
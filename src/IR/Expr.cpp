@@ -78,6 +78,49 @@ Select::Select(ExprPtr cond, ExprPtr tBranch, ExprPtr fBranch)
 Call::Call(CallFunction func, ArrayPtr<Expr> args, ScalarType dtype)
     : Expr(dtype, type), func(func), args(args) {}
 
+CallArgType Call::arg_type(size_t i) const {
+  ELENA_ASSERT(i < args->element.size(), "Call argument out of range");
+  switch (func) {
+    case CallFunction::area_row:
+    case CallFunction::area_col:
+    case CallFunction::pil_row:
+    case CallFunction::pil_col:
+      // the source pixel (or row) is a lambda of the window iterator, the
+      // weights are taken by address.
+      if (i == 0) return CallArgType::Body;
+      if (i == 1) {
+        ELENA_ASSERT(args->element[i]->get_type() == IRNodeType::IterVar,
+                     "Binder argument of a Call is not an IterVar");
+        return CallArgType::Binder;
+      }
+      return i == 4 ? CallArgType::Address : CallArgType::Value;
+    case CallFunction::warp_bilinear:
+      // the source pixel is a lambda of the tap iterators.
+      if (i == 0) return CallArgType::Body;
+      if (i == 1 || i == 2) {
+        ELENA_ASSERT(args->element[i]->get_type() == IRNodeType::IterVar,
+                     "Binder argument of a Call is not an IterVar");
+        return CallArgType::Binder;
+      }
+      return CallArgType::Value;
+    case CallFunction::bilinear_resize_preprocess:
+    case CallFunction::bilinear_float_resize_preprocess:
+      return i >= 4 ? CallArgType::Address : CallArgType::Value;
+    case CallFunction::atomic_add:
+    case CallFunction::atomic_max:
+    case CallFunction::atomic_min:
+      return i == 0 ? CallArgType::Address : CallArgType::Value;
+    case CallFunction::wmma_fill_fragment:
+    case CallFunction::wmma_load_matrix_sync:
+    case CallFunction::wmma_store_matrix_sync:
+    case CallFunction::wmma_mma_sync:
+    case CallFunction::wmma_fragment:
+      return CallArgType::Address;
+    default:
+      return CallArgType::Value;
+  }
+}
+
 template <typename T>
 Const<T>::Const(T value, ScalarType dtype) : Expr(dtype, type), value(value) {
   name = GENERATE_NAME(Const);
@@ -1,6 +1,7 @@
 #include "IR/IRUtil.h"
 
 #include <iostream>
+#include <unordered_set>
 
 #include "IR/VisitorBase.h"
 #include "api.h"
@@ -59,10 +60,27 @@ StmtPtr mergeNest(std::vector<StmtPtr> nest, StmtPtr body) {
 }
 
 /// Cast Expr to instances of class IntSet.
+///
+/// The results are memoized per node, so one instance must only be used
+/// with a single version of the range map; indices that share subtrees
+/// (which is the common case after inlining) are then only evaluated once.
 class CastExpr2IntSet final : public VisitorBase<CastExpr2IntSet> {
  public:
   using VisitorBase<CastExpr2IntSet>::visit;
 
+  /// Constructor.
+  ///
+  /// Typical Usage:
+  /// \code
+  ///   CastExpr2IntSet(up_state);
+  /// \encode
+  ///
+  /// \param up_state_ records the ranges of IterVars, must outlive
+  /// this instance;
+  ///
+  /// \return Instance of class CastExpr2IntSet.
+  explicit CastExpr2IntSet(const Rmap& up_state_) : up_state(up_state_) {}
+
   /// Visit instances of class IterVar.
   ///
   /// Typical Usage:
@@ -75,7 +93,8 @@ class CastExpr2IntSet final : public VisitorBase<CastExpr2IntSet> {
   /// \return None.
   void visit(IterVar* iter_ptr) {
     // visit the arguments.
-    mid_result = up_state[iter_ptr->shared_from_this()];
+    auto it = up_state.find(iter_ptr->shared_from_this());
+    mid_result = it == up_state.end() ? nullptr : it->second;
   }
 
   /// Visit instances of class Const.
@@ -94,68 +113,60 @@ class CastExpr2IntSet final : public VisitorBase<CastExpr2IntSet> {
     mid_result->setSinglePoint(const_ptr->shared_from_this());
   }
 
-  /// Visit instances of class Const.
+  /// Visit instances of class Binary.
   ///
   /// Typical Usage:
   /// \code
-  ///   visit(const);
+  ///   visit(binary);
   /// \encode
   ///
-  /// \param const_ptr instance of class Const;
+  /// \param binary_ptr instance of class Binary;
   ///
   /// \return None.
   void visit(Binary* binary_ptr) {
-    if (binary_ptr->operation_type == ir::BinaryType::Add) {
-      visit(binary_ptr->lhs.get());
-      IntSetPtr lhs = std::make_shared<IntSet>(*mid_result);
-      visit(binary_ptr->rhs.get());
-      IntSetPtr rhs = std::make_shared<IntSet>(*mid_result);
-      mid_result = std::make_shared<IntSet>(*lhs + *rhs);
-    } else if (binary_ptr->operation_type == ir::BinaryType::Mul) {
-      visit(binary_ptr->lhs.get());
-      IntSetPtr lhs = std::make_shared<IntSet>(*mid_result);
-      visit(binary_ptr->rhs.get());
-      IntSetPtr rhs = std::make_shared<IntSet>(*mid_result);
-      printf("have not implement multiply for two IntSet\n");
-      mid_result = std::make_shared<IntSet>(*lhs * *rhs);
-    } else if (binary_ptr->operation_type == ir::BinaryType::Sub) {
-      visit(binary_ptr->lhs.get());
-      IntSetPtr lhs = std::make_shared<IntSet>(*mid_result);
-      visit(binary_ptr->rhs.get());
-      IntSetPtr rhs = std::make_shared<IntSet>(*mid_result);
-      printf("have not implement multiply for two IntSet\n");
-      mid_result = std::make_shared<IntSet>(*lhs - *rhs);
-    } else if (binary_ptr->operation_type == ir::BinaryType::Div) {
-      visit(binary_ptr->lhs.get());
-      IntSetPtr lhs = std::make_shared<IntSet>(*mid_result);
-      visit(binary_ptr->rhs.get());
-      IntSetPtr rhs = std::make_shared<IntSet>(*mid_result);
-      mid_result = std::make_shared<IntSet>(*lhs / *rhs);
-    } else if (binary_ptr->operation_type == ir::BinaryType::Mod) {
-      visit(binary_ptr->lhs.get());
-      IntSetPtr lhs = std::make_shared<IntSet>(*mid_result);
-      visit(binary_ptr->rhs.get());
-      IntSetPtr rhs = std::make_shared<IntSet>(*mid_result);
-      mid_result = std::make_shared<IntSet>(*lhs % *rhs);
-    } else {
-      std::string msg = "IntSet" + std::string(binary_ptr->get_type_name()) +
-                        "not implemented";
-      ELENA_ABORT(msg.c_str());
+    auto cached = cache.find(binary_ptr);
+    if (cached != cache.end()) {
+      mid_result = cached->second;
+      return;
+    }
+    visit(binary_ptr->lhs.get());
+    IntSetPtr lhs = mid_result;
+    visit(binary_ptr->rhs.get());
+    IntSetPtr rhs = mid_result;
+    switch (binary_ptr->operation_type) {
+      case ir::BinaryType::Add:
+        mid_result = std::make_shared<IntSet>(*lhs + *rhs);
+        break;
+      case ir::BinaryType::Mul:
+        mid_result = std::make_shared<IntSet>(*lhs * *rhs);
+        break;
+      case ir::BinaryType::Sub:
+        mid_result = std::make_shared<IntSet>(*lhs - *rhs);
+        break;
+      case ir::BinaryType::Div:
+        mid_result = std::make_shared<IntSet>(*lhs / *rhs);
+        break;
+      case ir::BinaryType::Mod:
+        mid_result = std::make_shared<IntSet>(*lhs % *rhs);
+        break;
+      default:
+        ELENA_ABORT("IntSet " << binary_ptr->get_type_name()
+                              << " not implemented");
     }
+    cache[binary_ptr] = mid_result;
   }
 
   /// Get the IntSet format of the given node.
   ///
   /// Typical Usage:
   /// \code
-  ///   getIntSet(node, up_state);
+  ///   getIntSet(node);
   /// \encode
   ///
-  /// \param up_state_ records the ranges of IterVars;
+  /// \param node the index expression to evaluate;
   ///
   /// \return the IntSet format of the node.
-  IntSetPtr getIntSet(const ir::NodePtr& node, Rmap up_state_) {
-    up_state = up_state_;
+  IntSetPtr getIntSet(const ir::NodePtr& node) {
     mid_result = std::make_shared<IntSet>();
     visit(node.get());
     return mid_result;
@@ -163,12 +174,14 @@ class CastExpr2IntSet final : public VisitorBase<CastExpr2IntSet> {
 
  private:
   IntSetPtr mid_result;
-  Rmap up_state;
+  const Rmap& up_state;
+  /// IntSets of the Binary nodes evaluated against up_state so far.
+  std::unordered_map<const ir::Node*, IntSetPtr> cache;
 };
 
-IntSetPtr expr2IntSet(ExprPtr expr, Rmap up_state_) {
-  CastExpr2IntSet tmp_cast;
-  return tmp_cast.getIntSet(expr, up_state_);
+IntSetPtr expr2IntSet(const ExprPtr& expr, const Rmap& up_state_) {
+  CastExpr2IntSet tmp_cast(up_state_);
+  return tmp_cast.getIntSet(expr);
 }
 
 /// Get the range of root IterVars of the current stage.
@@ -176,6 +189,23 @@ class InputBound final : public VisitorBase<InputBound> {
  public:
   using VisitorBase::visit;
 
+  /// Constructor.
+  ///
+  /// Typical Usage:
+  /// \code
+  ///   InputBound(up_state, tmap);
+  /// \encode
+  ///
+  /// \param up_state_ records the range of IterVars.
+  ///
+  /// \param tmap_ records the range of root IterVars of the
+  /// output tensor of the current stage.
+  ///
+  /// \return Instance of class InputBound.
+  InputBound(const Rmap& up_state_,
+             ir::TensorVarMap<std::vector<std::vector<IntSetPtr>>>* tmap_)
+      : tmap(tmap_), caster(up_state_) {}
+
   /// Visit instances of class ScalarVar.
   ///
   /// Typical Usage:
@@ -190,11 +220,15 @@ class InputBound final : public VisitorBase<InputBound> {
     // visit the arguments.
     auto tensor_var = ir::ptr_cast<TensorVar>(scalar_ptr->tensor);
     if (tensor_var == nullptr) return;
+    // A shared access yields the same IntSets again, which would not
+    // change the merged bound.
+    if (!visited.insert(scalar_ptr).second) return;
     if (scalar_ptr->indices) visit(scalar_ptr->indices);
-    if (tmap.count(tensor_var)) {
+    auto bounds = tmap->find(tensor_var);
+    if (bounds != tmap->end()) {
       for (int i = 0; i < scalar_ptr->indices->element.size(); i++) {
-        tmap[tensor_var][i].push_back(
-            expr2IntSet(scalar_ptr->indices->element[i], up_state));
+        bounds->second[i].push_back(
+            caster.getIntSet(scalar_ptr->indices->element[i]));
       }
     }
   }
@@ -203,37 +237,25 @@ class InputBound final : public VisitorBase<InputBound> {
   ///
   /// Typical Usage:
   /// \code
-  ///   updateInputBound(expr, up_state, tmap);
+  ///   updateInputBound(expr);
   /// \encode
   ///
   /// \param expr usually the pointer to the expression containing
   /// the instance of class ScalarVar in terms of the output tensor
   /// of the current stage;
   ///
-  /// \param up_state_ records the range of IterVars.
-  ///
-  /// \param tmap_ records the range of root IterVars of the
-  /// output tensor of the current stage.
-  ///
   /// \return None.
-  void updateInputBound(
-      ExprPtr expr, Rmap* up_state_,
-      ir::TensorVarMap<std::vector<std::vector<IntSetPtr>>>* tmap_) {
-    up_state = *up_state_;
-    tmap = *tmap_;
-    visit(expr.get());
-    *up_state_ = up_state;
-    *tmap_ = tmap;
-  }
+  void updateInputBound(const ExprPtr& expr) { visit(expr.get()); }
 
  private:
-  Rmap up_state;
-  ir::TensorVarMap<std::vector<std::vector<IntSetPtr>>> tmap;
+  ir::TensorVarMap<std::vector<std::vector<IntSetPtr>>>* tmap;
+  CastExpr2IntSet caster;
+  std::unordered_set<const ScalarVar*> visited;
 };
 
 void propBoundToInputs(
-    ExprPtr expr, Rmap* up_state,
+    const ExprPtr& expr, const Rmap& up_state,
     ir::TensorVarMap<std::vector<std::vector<IntSetPtr>>>* tmap) {
-  InputBound tmp;
-  tmp.updateInputBound(expr, up_state, tmap);
+  InputBound tmp(up_state, tmap);
+  tmp.updateInputBound(expr);
 }
@@ -18,14 +18,44 @@ uint64_t getConstVal(const ExprPtr& expr) {
   return const_ptr->get_value();
 }
 
+bool isConstVal(const ExprPtr& expr, uint64_t value) {
+  return isConst(expr) && expr->get_dtype() == ir::ScalarType::UInt64 &&
+         getConstVal(expr) == value;
+}
+
+/// Fold the trivial cases of range arithmetic (x + 0, x * 1, x * 0, x - x,
+/// ...) without building a new Binary node, so that the bound of a deeply
+/// inlined index does not grow with every stage it passes through.
+ExprPtr foldIdentity(char op, const ExprPtr& lhs, const ExprPtr& rhs) {
+  switch (op) {
+    case '+':
+      if (isConstVal(lhs, 0)) return rhs;
+      if (isConstVal(rhs, 0)) return lhs;
+      break;
+    case '-':
+      if (lhs == rhs) return api::constant<uint64_t>(0);
+      if (isConstVal(rhs, 0)) return lhs;
+      break;
+    case '*':
+      if (isConstVal(lhs, 0) || isConstVal(rhs, 1)) return lhs;
+      if (isConstVal(rhs, 0) || isConstVal(lhs, 1)) return rhs;
+      break;
+    case '/':
+      if (isConstVal(rhs, 1)) return lhs;
+      break;
+    default:
+      break;
+  }
+  return nullptr;
+}
+
 #define BUILD_EXPR_EVAL(res, op, lhs, rhs)                                 \
   {                                                                        \
     if (isConst(lhs) && isConst(rhs)) {                                    \
       res = api::constant<uint64_t>(getConstVal(lhs) op getConstVal(rhs)); \
-    } else if ((lhs == rhs) && (#op == std::string("-"))) {                \
-      res = api::constant<uint64_t>(0);                                    \
     } else {                                                               \
-      res = lhs op rhs;                                                    \
+      ExprPtr folded = foldIdentity(#op[0], lhs, rhs);                     \
+      res = folded ? folded : lhs op rhs;                                  \
     }                                                                      \
   }
 }  // namespace
@@ -95,6 +95,8 @@ void Split(StagePtr self, IterVarPtr parent, ExprPtr factor, ExprPtr nparts,
                                                  parent->is_reduce);
   p_outer->iter_type = parent->iter_type;
   p_inner->iter_type = parent->iter_type;
+  p_outer->unroll_factor = parent->unroll_factor;
+  p_inner->unroll_factor = parent->unroll_factor;
 
   self->relations->element.push_back(std::make_shared<SplitRelation>(
       parent, p_outer, p_inner, factor, nparts));
@@ -314,6 +316,12 @@ StagePtr Stage::unroll(IterVarPtr iter) {
   return shared_from_this();
 }
 
+StagePtr Stage::unroll(IterVarPtr iter, uint64_t factor) {
+  Updateattr(shared_from_this(), iter, IterAttrType::Unrolled);
+  iter->unroll_factor = factor;
+  return shared_from_this();
+}
+
 StagePtr Stage::parallel(IterVarPtr iter) {
   Updateattr(shared_from_this(), iter, IterAttrType::Parallelized);
   return shared_from_this();
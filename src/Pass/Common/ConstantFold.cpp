@@ -0,0 +1,209 @@
+#include "Pass/Common/ConstantFold.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "api.h"
+
+namespace {
+/// Reads an integer or boolean constant, floats are never folded.
+bool readInteger(const ir::ExprPtr &expr, int64_t *value) {
+  if (expr->get_type() != ir::IRNodeType::Const) return false;
+  switch (expr->get_dtype()) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type)            \
+  case ir::ScalarType::scalar_type: {                                      \
+    auto v = static_cast<Const<native_type> *>(expr.get())->get_value();   \
+    if (static_cast<uint64_t>(v) >                                         \
+            static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) &&  \
+        v > 0)                                                             \
+      return false;                                                        \
+    *value = static_cast<int64_t>(v);                                      \
+    return true;                                                           \
+  }
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return false;
+  }
+}
+
+template <typename T>
+bool evalBinary(ir::BinaryType op, T a, T b, T *out) {
+  switch (op) {
+    case ir::BinaryType::Add:
+      *out = a + b;
+      return true;
+    case ir::BinaryType::Sub:
+      *out = a - b;
+      return true;
+    case ir::BinaryType::Mul:
+      *out = a * b;
+      return true;
+    case ir::BinaryType::Div:
+      if (b == 0) return false;
+      *out = a / b;
+      return true;
+    case ir::BinaryType::Mod:
+      if (b == 0) return false;
+      *out = a % b;
+      return true;
+    case ir::BinaryType::Max:
+      *out = std::max(a, b);
+      return true;
+    case ir::BinaryType::Min:
+      *out = std::min(a, b);
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// 'true && x' is x, 'false && x' is false, and dually for '||'.  Returns
+/// nullptr if neither operand is a constant.
+ir::ExprPtr foldAndOr(bool is_and, const ir::ExprPtr &lhs,
+                      const ir::ExprPtr &rhs) {
+  int64_t value;
+  bool lhs_const = readInteger(lhs, &value);
+  if (!lhs_const && !readInteger(rhs, &value)) return nullptr;
+  auto other = lhs_const ? rhs : lhs;
+  if ((value != 0) != is_and) {
+    return std::make_shared<Const<bool>>(value != 0, ir::ScalarType::Boolean);
+  }
+  return other->get_dtype() == ir::ScalarType::Boolean ? other : nullptr;
+}
+
+/// 'x + 0', '0 + x', 'x - 0', 'x * 1' and '1 * x' are x, 'x * 0' and
+/// '0 * x' are 0.  Only for integers and only if the kept operand has the
+/// type of the node.  Returns nullptr if no identity applies.
+ir::ExprPtr foldIdentity(ir::Binary *node) {
+  auto dtype = node->get_dtype();
+  if (dtype == ir::ScalarType::Boolean) return nullptr;
+  // the constant operand, its value and the other operand.
+  int64_t value;
+  ir::ExprPtr constant, other;
+  if (node->rhs->get_dtype() == dtype && readInteger(node->rhs, &value)) {
+    constant = node->rhs;
+    other = node->lhs;
+  } else if (node->operation_type != ir::BinaryType::Sub &&
+             node->lhs->get_dtype() == dtype &&
+             readInteger(node->lhs, &value)) {
+    constant = node->lhs;
+    other = node->rhs;
+  } else {
+    return nullptr;
+  }
+  switch (node->operation_type) {
+    case ir::BinaryType::Add:
+    case ir::BinaryType::Sub:
+      if (value != 0) return nullptr;
+      break;
+    case ir::BinaryType::Mul:
+      if (value == 0) return constant;
+      if (value != 1) return nullptr;
+      break;
+    default:
+      return nullptr;
+  }
+  return other->get_dtype() == dtype ? other : nullptr;
+}
+
+bool evalLogical(ir::LogicalType op, int64_t a, int64_t b) {
+  switch (op) {
+#define TYPE_LOGICALTYPE_OP_MAP(name, op) \
+  case ir::LogicalType::name:             \
+    return a op b;
+#include "x/logical_types.def"
+  }
+  return false;
+}
+}  // namespace
+
+ir::NodePtr ConstantFolder::visit(ir::Binary *node) {
+  mutate(node->lhs);
+  mutate(node->rhs);
+  auto dtype = node->get_dtype();
+  // 'api::logical::all' chains conditions with a bitwise and.
+  if (dtype == ir::ScalarType::Boolean &&
+      (node->operation_type == ir::BinaryType::And ||
+       node->operation_type == ir::BinaryType::Or)) {
+    auto folded = foldAndOr(node->operation_type == ir::BinaryType::And,
+                            node->lhs, node->rhs);
+    return folded ? folded : node->shared_from_this();
+  }
+  if (node->lhs->get_type() != ir::IRNodeType::Const ||
+      node->rhs->get_type() != ir::IRNodeType::Const ||
+      node->lhs->get_dtype() != dtype || node->rhs->get_dtype() != dtype) {
+    auto folded = foldIdentity(node);
+    return folded ? folded : node->shared_from_this();
+  }
+  // evaluated in the native type, so wrap-around matches the generated code.
+  switch (dtype) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type)              \
+  case ir::ScalarType::scalar_type: {                                        \
+    native_type value;                                                       \
+    if (evalBinary<native_type>(                                             \
+            node->operation_type,                                            \
+            static_cast<Const<native_type> *>(node->lhs.get())->get_value(), \
+            static_cast<Const<native_type> *>(node->rhs.get())->get_value(), \
+            &value))                                                         \
+      return std::make_shared<Const<native_type>>(value, dtype);             \
+    break;                                                                   \
+  }
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      break;
+  }
+  return node->shared_from_this();
+}
+
+ir::NodePtr ConstantFolder::visit(ir::Logical *node) {
+  mutate(node->lhs);
+  mutate(node->rhs);
+  int64_t lhs, rhs;
+  bool lhs_const = readInteger(node->lhs, &lhs);
+  bool rhs_const = readInteger(node->rhs, &rhs);
+  if (lhs_const && rhs_const) {
+    return std::make_shared<Const<bool>>(
+        evalLogical(node->operation_type, lhs, rhs), ir::ScalarType::Boolean);
+  }
+  if (node->operation_type == ir::LogicalType::AND ||
+      node->operation_type == ir::LogicalType::OR) {
+    auto folded = foldAndOr(node->operation_type == ir::LogicalType::AND,
+                            node->lhs, node->rhs);
+    if (folded) return folded;
+  }
+  return node->shared_from_this();
+}
+
+ir::NodePtr ConstantFolder::visit(ir::Select *node) {
+  mutate(node->cond);
+  int64_t cond;
+  if (readInteger(node->cond, &cond)) {
+    return cond ? derived().visit(node->tBranch.get())
+                : derived().visit(node->fBranch.get());
+  }
+  mutate(node->tBranch);
+  mutate(node->fBranch);
+  return node->shared_from_this();
+}
+
+ir::NodePtr ConstantFolder::visit(ir::IfThenElse *node) {
+  mutate(node->condition);
+  int64_t cond;
+  if (readInteger(node->condition, &cond) && (cond || node->else_case)) {
+    return cond ? derived().visit(node->then_case.get())
+                : derived().visit(node->else_case.get());
+  }
+  mutate(node->then_case);
+  if (node->else_case) mutate(node->else_case);
+  return node->shared_from_this();
+}
+
+namespace api {
+ir::StmtPtr foldConstants(ir::StmtPtr stmt) {
+  ConstantFolder folder;
+  return ir::ptr_cast<ir::Stmt>(folder.visit(stmt.get()));
+}
+}  // namespace api
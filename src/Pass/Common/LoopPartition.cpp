@@ -0,0 +1,271 @@
+#include "Pass/Common/LoopPartition.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "IR/ExprEqual.h"
+#include "IR/VisitorBase.h"
+#include "Pass/Common/StmtCopy.h"
+
+namespace {
+
+bool isUnsigned(ir::ScalarType dtype) {
+  return dtype == ir::ScalarType::UInt8 || dtype == ir::ScalarType::UInt32 ||
+         dtype == ir::ScalarType::UInt64;
+}
+
+/// Whether 'expr' is the loop variable, possibly cast.
+bool isIter(ir::ExprPtr expr, const ir::IterVarPtr &it) {
+  while (expr->get_type() == ir::IRNodeType::Cast) {
+    expr = ir::ptr_cast<ir::Cast>(expr)->expr_;
+  }
+  return expr->get_type() == ir::IRNodeType::IterVar &&
+         ir::ptr_cast<ir::IterVar>(expr)->get_name() == it->get_name();
+}
+
+bool isZero(const ir::ExprPtr &expr) {
+  if (expr->get_type() != ir::IRNodeType::Const) return false;
+  switch (expr->get_dtype()) {
+    case ir::ScalarType::UInt32:
+      return ir::ptr_cast<ir::Const<uint32_t>>(expr)->get_value() == 0;
+    case ir::ScalarType::UInt64:
+      return ir::ptr_cast<ir::Const<uint64_t>>(expr)->get_value() == 0;
+    default:
+      return false;
+  }
+}
+
+/// Kernel arguments and constants only, so the value is the same in every
+/// iteration of any loop.
+bool invariant(const ir::ExprPtr &expr) {
+  switch (expr->get_type()) {
+    case ir::IRNodeType::Const:
+      return true;
+    case ir::IRNodeType::ScalarVar:
+      return ir::ptr_cast<ir::ScalarVar>(expr)->is_placeholder();
+    case ir::IRNodeType::Cast:
+      return invariant(ir::ptr_cast<ir::Cast>(expr)->expr_);
+    case ir::IRNodeType::Unary:
+      return invariant(ir::ptr_cast<ir::Unary>(expr)->operand);
+    case ir::IRNodeType::Binary: {
+      auto binary = ir::ptr_cast<ir::Binary>(expr);
+      return invariant(binary->lhs) && invariant(binary->rhs);
+    }
+    default:
+      return false;
+  }
+}
+
+void conjuncts(const ir::ExprPtr &cond, std::vector<ir::ExprPtr> *terms) {
+  if (cond->get_type() == ir::IRNodeType::Binary) {
+    auto binary = ir::ptr_cast<ir::Binary>(cond);
+    if (binary->operation_type == ir::BinaryType::And) {
+      conjuncts(binary->lhs, terms);
+      conjuncts(binary->rhs, terms);
+      return;
+    }
+  }
+  terms->push_back(cond);
+}
+
+ir::ExprPtr castTo(const ir::ExprPtr &expr, ir::ScalarType dtype) {
+  if (expr->get_dtype() == dtype) return expr;
+  return std::make_shared<ir::Cast>(expr, dtype);
+}
+
+ir::ExprPtr binary(const ir::ExprPtr &lhs, const ir::ExprPtr &rhs,
+                   ir::BinaryType op) {
+  return std::make_shared<ir::Binary>(lhs, rhs, op);
+}
+
+/// A select testing 'it >= lower && it < upper' among its conjuncts.
+struct Interval {
+  ir::Select *select;
+  ir::ExprPtr lower, upper;
+  // the other conjuncts.
+  std::vector<ir::ExprPtr> rest;
+};
+
+class SelectCollector : public VisitorBase<SelectCollector> {
+ public:
+  using VisitorBase::visit;
+  void visit(ir::Select *node) {
+    selects.push_back(node);
+    VisitorBase::visit(node);
+  }
+  void visit(ir::TensorVar *node) {}
+
+  std::vector<ir::Select *> selects;
+};
+
+bool matchInterval(ir::Select *select, const ir::IterVarPtr &it,
+                   Interval *interval) {
+  std::vector<ir::ExprPtr> terms;
+  conjuncts(select->cond, &terms);
+  interval->select = select;
+  interval->lower = interval->upper = nullptr;
+  interval->rest.clear();
+  for (const auto &term : terms) {
+    if (term->get_type() == ir::IRNodeType::Logical) {
+      auto logical = ir::ptr_cast<ir::Logical>(term);
+      auto op = logical->operation_type;
+      // the comparison is exact in the type of the bound.
+      if ((op == ir::LogicalType::GE || op == ir::LogicalType::LT) &&
+          isIter(logical->lhs, it) && invariant(logical->rhs) &&
+          isUnsigned(logical->rhs->get_dtype()) &&
+          logical->lhs->get_dtype() == logical->rhs->get_dtype()) {
+        auto &bound =
+            op == ir::LogicalType::GE ? interval->lower : interval->upper;
+        if (!bound) {
+          bound = logical->rhs;
+          continue;
+        }
+      }
+    }
+    interval->rest.push_back(term);
+  }
+  return interval->lower && interval->upper;
+}
+
+/// The tests 'if (it < init + extent)' of a loop body, or 'if (it < extent)'
+/// once a zero 'init' is folded, mapped to their then case.  Every part of
+/// the loop ends at or before 'init + extent', so they always hold.
+class BoundCheckCollector : public VisitorBase<BoundCheckCollector> {
+ public:
+  explicit BoundCheckCollector(const ir::For *loop) : loop_(loop) {}
+
+  using VisitorBase::visit;
+  void visit(ir::IfThenElse *node) {
+    if (isBoundCheck(node->condition)) {
+      // nested checks are found once this one is removed.
+      checks[node] = node->then_case;
+      return;
+    }
+    VisitorBase::visit(node);
+  }
+  void visit(ir::TensorVar *node) {}
+
+  std::unordered_map<const ir::Node *, ir::NodePtr> checks;
+
+ private:
+  bool isBoundCheck(const ir::ExprPtr &cond) const {
+    if (cond->get_type() != ir::IRNodeType::Logical) return false;
+    auto logical = ir::ptr_cast<ir::Logical>(cond);
+    if (logical->operation_type != ir::LogicalType::LT ||
+        logical->lhs->get_type() != ir::IRNodeType::IterVar ||
+        ir::ptr_cast<ir::IterVar>(logical->lhs)->get_name() !=
+            loop_->it->get_name()) {
+      return false;
+    }
+    if (isZero(loop_->init) && EQ(logical->rhs, loop_->extent)) return true;
+    if (logical->rhs->get_type() != ir::IRNodeType::Binary) return false;
+    auto bound = ir::ptr_cast<ir::Binary>(logical->rhs);
+    return bound->operation_type == ir::BinaryType::Add &&
+           EQ(bound->lhs, loop_->init) && EQ(bound->rhs, loop_->extent);
+  }
+
+  const ir::For *loop_;
+};
+
+ir::StmtPtr dropBoundChecks(const ir::For *loop) {
+  auto body = loop->body;
+  for (;;) {
+    BoundCheckCollector collector(loop);
+    collector.visit(body.get());
+    if (collector.checks.empty()) return body;
+    body = StmtCowSubstitute(collector.checks).substitute(body);
+  }
+}
+
+}  // namespace
+
+ir::NodePtr LoopPartitioner::visit(ir::For *node) {
+  auto it = node->it;
+  if (node->for_type != ir::ForType::Serial ||
+      (it->iter_type != ir::IterAttrType::Data &&
+       it->iter_type != ir::IterAttrType::Parallelized) ||
+      !isUnsigned(it->get_dtype())) {
+    mutate(node->body);
+    return node->shared_from_this();
+  }
+  node->body = dropBoundChecks(node);
+
+  SelectCollector collector;
+  collector.visit(node->body.get());
+  std::vector<Interval> intervals;
+  for (auto select : collector.selects) {
+    Interval interval;
+    if (!matchInterval(select, it, &interval)) continue;
+    if (!intervals.empty() && !(EQ(interval.lower, intervals[0].lower) &&
+                                EQ(interval.upper, intervals[0].upper))) {
+      continue;
+    }
+    intervals.push_back(interval);
+  }
+  if (intervals.empty()) {
+    mutate(node->body);
+    return node->shared_from_this();
+  }
+
+  // the interior [begin, end) clamped to the loop range.
+  auto dtype = it->get_dtype();
+  auto init = node->init;
+  auto last = binary(init, node->extent, ir::BinaryType::Add);
+  auto lower = intervals[0].lower, upper = intervals[0].upper;
+  auto clamp = [&](const ir::ExprPtr &bound, const ir::ExprPtr &low) {
+    auto bdtype = bound->get_dtype();
+    auto value = binary(binary(bound, castTo(low, bdtype), ir::BinaryType::Max),
+                        castTo(last, bdtype), ir::BinaryType::Min);
+    return castTo(value, dtype);
+  };
+  auto begin =
+      std::make_shared<ir::IterVar>(it->range, it->get_name() + ".begin");
+  auto end = std::make_shared<ir::IterVar>(it->range, it->get_name() + ".end");
+  begin->set_dtype(dtype);
+  end->set_dtype(dtype);
+
+  std::unordered_map<const ir::Node *, ir::NodePtr> border, interior;
+  for (const auto &interval : intervals) {
+    auto select = interval.select;
+    border[select] = select->fBranch;
+    if (interval.rest.empty()) {
+      interior[select] = select->tBranch;
+    } else {
+      auto cond = interval.rest[0];
+      for (size_t i = 1; i < interval.rest.size(); ++i) {
+        cond = binary(cond, interval.rest[i], ir::BinaryType::And);
+      }
+      interior[select] =
+          std::make_shared<ir::Select>(cond, select->tBranch, select->fBranch);
+    }
+  }
+  // every part gets its own copy of the rewritten nodes.
+  auto head_body = StmtCowSubstitute(border).substitute(node->body);
+  auto mid_body = StmtCowSubstitute(interior).substitute(node->body);
+  auto tail_body = StmtCowSubstitute(border).substitute(node->body);
+
+  auto part = [&](const ir::ExprPtr &from, const ir::ExprPtr &to,
+                  const ir::StmtPtr &body) {
+    auto loop = std::make_shared<ir::For>(*node);
+    loop->init = from;
+    loop->extent = binary(to, from, ir::BinaryType::Sub);
+    loop->body = body;
+    return loop;
+  };
+  ir::StmtPtr res = std::make_shared<ir::Block>(
+      std::make_shared<ir::Block>(part(init, begin, head_body),
+                                  part(begin, end, mid_body)),
+      part(end, last, tail_body));
+  res = std::make_shared<ir::Let>(end, clamp(upper, begin), res);
+  res = std::make_shared<ir::Let>(begin, clamp(lower, init), res);
+  // the parts no longer test this interval, split the inner loops.
+  mutate(res);
+  return res;
+}
+
+namespace api {
+ir::StmtPtr partitionLoops(ir::StmtPtr stmt) {
+  LoopPartitioner partitioner;
+  return ir::ptr_cast<ir::Stmt>(partitioner.visit(stmt.get()));
+}
+}  // namespace api
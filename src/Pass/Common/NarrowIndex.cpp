@@ -0,0 +1,501 @@
+#include "Pass/Common/NarrowIndex.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "api.h"
+
+namespace {
+using Int = __int128;
+
+// ranges saturate here, far beyond any 64-bit value but safe to multiply.
+const Int kInf = Int(1) << 100;
+const Int kUInt32Max = std::numeric_limits<uint32_t>::max();
+// integers up to here are exact in a float, so float ranges stay sound.
+const Int kFloatExact = Int(1) << 24;
+
+Int clamp(Int v) { return std::max(-kInf, std::min(kInf, v)); }
+
+Int mul(Int a, Int b) {
+  if (a == 0 || b == 0) return 0;
+  Int abs_a = a < 0 ? -a : a, abs_b = b < 0 ? -b : b;
+  if (abs_a > kInf / abs_b) return (a < 0) != (b < 0) ? -kInf : kInf;
+  return a * b;
+}
+
+bool isInteger(ir::ScalarType dtype) {
+  switch (dtype) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type) \
+  case ir::ScalarType::scalar_type:                             \
+    return true;
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return false;
+  }
+}
+
+int bitsOf(ir::ScalarType dtype) {
+  switch (dtype) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type) \
+  case ir::ScalarType::scalar_type:                             \
+    return sizeof(native_type) * 8;
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return 0;
+  }
+}
+
+bool isSigned(ir::ScalarType dtype) {
+  switch (dtype) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type) \
+  case ir::ScalarType::scalar_type:                             \
+    return std::numeric_limits<native_type>::is_signed;
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return true;
+  }
+}
+
+bool readInteger(const ir::ExprPtr &expr, Int *value) {
+  if (expr->get_type() != ir::IRNodeType::Const) return false;
+  switch (expr->get_dtype()) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type)                \
+  case ir::ScalarType::scalar_type:                                            \
+    *value = static_cast<Const<native_type> *>(expr.get())->get_value();       \
+    return true;
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return false;
+  }
+}
+
+/// The type C computes 'a op b' in: integers narrower than int are promoted,
+/// then the wider operand wins, unsigned on a tie.
+ir::ScalarType promote(ir::ScalarType a, ir::ScalarType b) {
+  if (!isInteger(a) || !isInteger(b)) return ir::ScalarType::Float32;
+  if (bitsOf(a) < 32) a = ir::ScalarType::Int32;
+  if (bitsOf(b) < 32) b = ir::ScalarType::Int32;
+  if (bitsOf(a) != bitsOf(b)) return bitsOf(a) > bitsOf(b) ? a : b;
+  return isSigned(a) ? b : a;
+}
+
+bool isRing(ir::BinaryType op) {
+  return op == ir::BinaryType::Add || op == ir::BinaryType::Sub ||
+         op == ir::BinaryType::Mul;
+}
+
+/// Narrowing these only pays off when they replace real arithmetic.
+bool isTrivial(const ir::ExprPtr &expr) {
+  return expr->get_type() == ir::IRNodeType::Cast ||
+         expr->get_type() == ir::IRNodeType::Const;
+}
+
+ir::ExprPtr toUInt32(const ir::ExprPtr &expr) {
+  return std::make_shared<ir::Cast>(expr, ir::ScalarType::UInt32);
+}
+
+using Interval = IndexNarrower::Interval;
+
+Interval typeRange(ir::ScalarType dtype) {
+  switch (dtype) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type) \
+  case ir::ScalarType::scalar_type:                             \
+    return {std::numeric_limits<native_type>::min(),            \
+            std::numeric_limits<native_type>::max()};
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return {-kInf, kInf};
+  }
+}
+
+bool fits(const Interval &range, const Interval &type) {
+  return range.lo >= type.lo && range.hi <= type.hi;
+}
+
+bool isExactFloat(const Interval &range) {
+  return range.lo >= -kFloatExact && range.hi <= kFloatExact;
+}
+
+bool fitsUInt32(const Interval &range) {
+  return range.lo >= 0 && range.hi <= kUInt32Max;
+}
+
+ir::IterVarPtr narrowedCopy(const ir::IterVarPtr &iter) {
+  auto copy =
+      std::make_shared<ir::IterVar>(iter->range, iter->get_name(),
+                                    iter->is_reduce);
+  copy->iter_type = iter->iter_type;
+  copy->unroll_factor = iter->unroll_factor;
+  copy->thread_tag = iter->thread_tag;
+  copy->fullfill_range = iter->fullfill_range;
+  copy->set_dtype(ir::ScalarType::UInt32);
+  return copy;
+}
+}  // namespace
+
+
+IndexNarrower::IndexNarrower(
+    const std::unordered_map<std::string, uint64_t> &var_max)
+    : var_max_(var_max) {}
+
+IndexNarrower::Info IndexNarrower::info(const ir::ExprPtr &expr) {
+  auto found = cache_.find(expr);
+  if (found != cache_.end()) return found->second;
+  auto result = compute(expr);
+  result.range.lo = clamp(result.range.lo);
+  result.range.hi = clamp(result.range.hi);
+  cache_[expr] = result;
+  return result;
+}
+
+Interval IndexNarrower::value(const ir::ExprPtr &expr) {
+  auto i = info(expr);
+  auto type = typeRange(i.ctype);
+  return fits(i.range, type) ? i.range : type;
+}
+
+IndexNarrower::Info IndexNarrower::compute(const ir::ExprPtr &expr) {
+  auto dtype = expr->get_dtype();
+  Int constant;
+  switch (expr->get_type()) {
+    case ir::IRNodeType::Const:
+      if (readInteger(expr, &constant)) return {{constant, constant}, dtype};
+      break;
+    case ir::IRNodeType::ScalarVar: {
+      auto var = ir::ptr_cast<ir::ScalarVar>(expr);
+      if (!var->is_placeholder()) break;
+      if (bound_.count(var.get())) return {bound_[var.get()], dtype};
+      auto max = var_max_.find(var->get_name());
+      if (max != var_max_.end() && isInteger(dtype)) {
+        return {{0, max->second}, dtype};
+      }
+      break;
+    }
+    case ir::IRNodeType::IterVar:
+      if (bound_.count(expr.get())) return {bound_[expr.get()], dtype};
+      break;
+    case ir::IRNodeType::Cast: {
+      auto child = ir::ptr_cast<ir::Cast>(expr)->expr_;
+      auto range = value(child);
+      if (isInteger(dtype) != isInteger(info(child).ctype)) {
+        // float to integer truncates, which stays in range when positive.
+        if (!isExactFloat(range) || (isInteger(dtype) && range.lo < 0)) break;
+      }
+      if (fits(range, typeRange(dtype))) return {range, dtype};
+      break;
+    }
+    case ir::IRNodeType::Unary: {
+      auto unary = ir::ptr_cast<ir::Unary>(expr);
+      auto op = unary->operation_type;
+      if (isInteger(dtype) ||
+          (op != ir::UnaryType::Ceil && op != ir::UnaryType::Floor &&
+           op != ir::UnaryType::Round)) {
+        break;
+      }
+      // ranges have integral bounds, which rounding cannot cross.
+      return {value(unary->operand), dtype};
+    }
+    case ir::IRNodeType::Select: {
+      auto select = ir::ptr_cast<ir::Select>(expr);
+      auto ctype = promote(info(select->tBranch).ctype,
+                           info(select->fBranch).ctype);
+      if (!isInteger(ctype)) break;
+      auto t = value(select->tBranch), f = value(select->fBranch);
+      return {{std::min(t.lo, f.lo), std::max(t.hi, f.hi)}, ctype};
+    }
+    case ir::IRNodeType::Binary: {
+      auto binary = ir::ptr_cast<ir::Binary>(expr);
+      auto lhs = info(binary->lhs), rhs = info(binary->rhs);
+      auto ctype = promote(lhs.ctype, rhs.ctype);
+      auto op = binary->operation_type;
+      if (!isInteger(ctype)) return {floatRange(op, binary), ctype};
+      if (isRing(op)) {
+        // congruent to the computed value modulo 2^bits, so operands of the
+        // same width can be combined without checking for overflow.
+        int bits = bitsOf(ctype);
+        auto a = bitsOf(lhs.ctype) == bits ? lhs.range : value(binary->lhs);
+        auto b = bitsOf(rhs.ctype) == bits ? rhs.range : value(binary->rhs);
+        if (op == ir::BinaryType::Add) {
+          return {{a.lo + b.lo, a.hi + b.hi}, ctype};
+        } else if (op == ir::BinaryType::Sub) {
+          return {{a.lo - b.hi, a.hi - b.lo}, ctype};
+        }
+        Int p[] = {mul(a.lo, b.lo), mul(a.lo, b.hi), mul(a.hi, b.lo),
+                   mul(a.hi, b.hi)};
+        return {{*std::min_element(p, p + 4), *std::max_element(p, p + 4)},
+                ctype};
+      }
+      auto type = typeRange(ctype);
+      auto a = value(binary->lhs), b = value(binary->rhs);
+      if (!fits(a, type) || !fits(b, type)) return {type, ctype};
+      switch (op) {
+        case ir::BinaryType::Min:
+          return {{std::min(a.lo, b.lo), std::min(a.hi, b.hi)}, ctype};
+        case ir::BinaryType::Max:
+          return {{std::max(a.lo, b.lo), std::max(a.hi, b.hi)}, ctype};
+        case ir::BinaryType::Div:
+          if (a.lo >= 0 && b.lo > 0) return {{a.lo / b.hi, a.hi / b.lo}, ctype};
+          break;
+        case ir::BinaryType::Mod:
+          if (a.lo >= 0 && b.lo > 0) {
+            return {{0, std::min(a.hi, b.hi - 1)}, ctype};
+          }
+          break;
+        case ir::BinaryType::Slr:
+          if (a.lo >= 0 && b.lo >= 0 && b.hi < bitsOf(ctype)) {
+            return {{a.lo >> static_cast<int>(b.hi),
+                     a.hi >> static_cast<int>(b.lo)},
+                    ctype};
+          }
+          break;
+        case ir::BinaryType::And:
+          if (a.lo >= 0 && b.lo >= 0) {
+            return {{0, std::min(a.hi, b.hi)}, ctype};
+          }
+          break;
+        default:
+          break;
+      }
+      return {type, ctype};
+    }
+    default:
+      break;
+  }
+  return {typeRange(dtype), dtype};
+}
+
+Interval IndexNarrower::floatRange(ir::BinaryType op,
+                                   const ir::BinaryPtr &binary) {
+  auto a = value(binary->lhs), b = value(binary->rhs);
+  if (!isExactFloat(a) || !isExactFloat(b)) return {-kInf, kInf};
+  Interval range{-kInf, kInf};
+  if (op == ir::BinaryType::Add) {
+    range = {a.lo + b.lo, a.hi + b.hi};
+  } else if (op == ir::BinaryType::Sub) {
+    range = {a.lo - b.hi, a.hi - b.lo};
+  } else if (op == ir::BinaryType::Mul) {
+    Int p[] = {a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi};
+    range = {*std::min_element(p, p + 4), *std::max_element(p, p + 4)};
+  } else if (op == ir::BinaryType::Div && a.lo >= 0 && b.lo > 0) {
+    // integral bounds around the real quotient.
+    range = {a.lo / b.hi, (a.hi + b.lo - 1) / b.lo};
+  }
+  return isExactFloat(range) ? range : Interval{-kInf, kInf};
+}
+
+ir::ExprPtr IndexNarrower::opaque(const ir::ExprPtr &expr) {
+  return toUInt32(ir::ptr_cast<ir::Expr>(visit(expr.get())));
+}
+
+ir::ExprPtr IndexNarrower::narrow(const ir::ExprPtr &expr, bool exact) {
+  // keeps common subexpressions shared.
+  auto &cache = narrowed_[exact];
+  auto found = cache.find(expr);
+  if (found != cache.end()) return found->second;
+  return cache[expr] = narrowUncached(expr, exact);
+}
+
+ir::ExprPtr IndexNarrower::narrowUncached(const ir::ExprPtr &expr,
+                                          bool exact) {
+  if (!isInteger(info(expr).ctype)) return nullptr;
+  if (exact && !fitsUInt32(value(expr))) return nullptr;
+  switch (expr->get_type()) {
+    case ir::IRNodeType::Const: {
+      Int constant;
+      readInteger(expr, &constant);
+      return std::make_shared<Const<uint32_t>>(
+          static_cast<uint32_t>(constant & kUInt32Max),
+          ir::ScalarType::UInt32);
+    }
+    case ir::IRNodeType::IterVar: {
+      auto found = replace_.find(expr.get());
+      if (found != replace_.end()) return found->second;
+      return expr->get_dtype() == ir::ScalarType::UInt32 ? expr
+                                                         : toUInt32(expr);
+    }
+    case ir::IRNodeType::ScalarVar:
+      if (!ir::ptr_cast<ir::ScalarVar>(expr)->is_placeholder()) break;
+      return expr->get_dtype() == ir::ScalarType::UInt32 ? expr
+                                                         : toUInt32(expr);
+    case ir::IRNodeType::Cast: {
+      auto child = ir::ptr_cast<ir::Cast>(expr)->expr_;
+      // truncating to less than 32 bits is not a no-op modulo 2^32.
+      if (bitsOf(expr->get_dtype()) < 32) break;
+      auto narrowed = narrow(child, exact);
+      if (narrowed) return narrowed;
+      break;
+    }
+    case ir::IRNodeType::Binary: {
+      auto binary = ir::ptr_cast<ir::Binary>(expr);
+      auto op = binary->operation_type;
+      bool ring = isRing(op);
+      if (!ring && op != ir::BinaryType::Div && op != ir::BinaryType::Mod &&
+          op != ir::BinaryType::Min && op != ir::BinaryType::Max &&
+          op != ir::BinaryType::Slr && op != ir::BinaryType::And) {
+        break;
+      }
+      // only '+', '-' and '*' commute with the truncation.
+      auto lhs = narrow(binary->lhs, !ring);
+      auto rhs = lhs ? narrow(binary->rhs, !ring) : nullptr;
+      if (!lhs || !rhs) break;
+      if (op == ir::BinaryType::Slr && value(binary->rhs).hi >= 32) break;
+      return std::make_shared<ir::Binary>(lhs, rhs, op);
+    }
+    default:
+      break;
+  }
+  return opaque(expr);
+}
+
+IndexNarrower::Int IndexNarrower::extentOf(const ir::TensorVarPtr &tensor,
+                                           size_t count, size_t i) {
+  if (!tensor || !tensor->shape) return kInf;
+  const auto &shape = tensor->shape->element;
+  if (count == shape.size()) return value(shape[i]).hi;
+  if (count != 1) return kInf;
+  // a flattened access.
+  Int elements = 1;
+  for (const auto &dim : shape) elements = mul(elements, value(dim).hi);
+  return elements;
+}
+
+ir::ExprPtr IndexNarrower::narrowIndex(const ir::ExprPtr &index, Int extent) {
+  // an access is in bounds, so its value fits whenever the tensor does.
+  auto narrowed = narrow(index, extent > kUInt32Max + 1);
+  return narrowed && !isTrivial(narrowed) ? narrowed : nullptr;
+}
+
+ir::NodePtr IndexNarrower::visit(ir::For *node) {
+  if (!seen_.insert(node->shared_from_this()).second) {
+    return node->shared_from_this();
+  }
+  auto init = value(node->init), extent = value(node->extent);
+  Interval range{init.lo, std::max(init.lo, init.hi + extent.hi - 1)};
+  bound_[node->it.get()] = range;
+  auto narrowed_init = narrow(node->init, true);
+  auto narrowed_extent = narrow(node->extent, true);
+  // 'it < init + extent' is evaluated in the iterator type as well.
+  if (narrowed_init && narrowed_extent && init.hi + extent.hi <= kUInt32Max &&
+      isInteger(node->it->get_dtype())) {
+    auto it = narrowedCopy(node->it);
+    bound_[it.get()] = range;
+    replace_[node->it.get()] = it;
+    node->it = it;
+    node->init = narrowed_init;
+    node->extent = narrowed_extent;
+  } else {
+    mutate(node->init);
+    mutate(node->extent);
+  }
+  mutate(node->body);
+  return node->shared_from_this();
+}
+
+ir::NodePtr IndexNarrower::visit(ir::Let *node) {
+  auto range = value(node->value);
+  bound_[node->var.get()] = range;
+  auto narrowed = node->var->get_type() == ir::IRNodeType::IterVar
+                      ? narrow(node->value, true)
+                      : nullptr;
+  if (narrowed) {
+    auto var = narrowedCopy(ir::ptr_cast<ir::IterVar>(node->var));
+    bound_[var.get()] = range;
+    replace_[node->var.get()] = var;
+    node->var = var;
+    node->value = narrowed;
+  } else {
+    mutate(node->value);
+  }
+  mutate(node->body);
+  return node->shared_from_this();
+}
+
+ir::NodePtr IndexNarrower::visit(ir::Attr *node) {
+  if ((node->key == ir::AttrType::ThreadExtent ||
+       node->key == ir::AttrType::VirtualThread) &&
+      node->node->get_type() == ir::IRNodeType::IterVar) {
+    auto extent = value(ir::ptr_cast<ir::Expr>(node->value));
+    bound_[node->node.get()] = {0, std::max(Int(0), extent.hi - 1)};
+  }
+  return MutatorBase::visit(node);
+}
+
+ir::NodePtr IndexNarrower::visit(ir::Store *node) {
+  if (!seen_.insert(node->shared_from_this()).second) {
+    return node->shared_from_this();
+  }
+  mutate(node->value);
+  auto tensor = node->var->get_type() == ir::IRNodeType::TensorVar
+                    ? ir::ptr_cast<ir::TensorVar>(node->var)
+                    : nullptr;
+  auto &index = node->index->element;
+  for (size_t i = 0; i < index.size(); ++i) {
+    auto narrowed = narrowIndex(index[i], extentOf(tensor, index.size(), i));
+    if (narrowed) {
+      index[i] = narrowed;
+    } else {
+      mutate(index[i]);
+    }
+  }
+  return node->shared_from_this();
+}
+
+ir::NodePtr IndexNarrower::visit(ir::ScalarVar *node) {
+  if (node->is_placeholder() ||
+      !seen_.insert(node->shared_from_this()).second) {
+    return node->shared_from_this();
+  }
+  auto &index = node->indices->element;
+  for (size_t i = 0; i < index.size(); ++i) {
+    auto narrowed =
+        narrowIndex(index[i], extentOf(node->tensor, index.size(), i));
+    if (narrowed) {
+      index[i] = narrowed;
+    } else {
+      mutate(index[i]);
+    }
+  }
+  return node->shared_from_this();
+}
+
+ir::NodePtr IndexNarrower::visit(ir::Logical *node) {
+  if (!seen_.insert(node->shared_from_this()).second) {
+    return node->shared_from_this();
+  }
+  // a comparison needs both values, not just their low 32 bits.
+  auto lhs = narrow(node->lhs, true);
+  auto rhs = lhs ? narrow(node->rhs, true) : nullptr;
+  if (lhs && rhs && (!isTrivial(lhs) || !isTrivial(rhs))) {
+    node->lhs = lhs;
+    node->rhs = rhs;
+  } else {
+    mutate(node->lhs);
+    mutate(node->rhs);
+  }
+  return node->shared_from_this();
+}
+
+ir::NodePtr IndexNarrower::visit(ir::IterVar *node) {
+  auto found = replace_.find(node);
+  if (found == replace_.end()) return node->shared_from_this();
+  // widen again for the code that stays 64-bit.
+  return std::make_shared<ir::Cast>(found->second, node->get_dtype());
+}
+
+namespace api {
+ir::StmtPtr narrowIndex(
+    ir::StmtPtr stmt, const std::unordered_map<std::string, uint64_t> &var_max) {
+  IndexNarrower narrower(var_max);
+  return ir::ptr_cast<ir::Stmt>(narrower.visit(stmt.get()));
+}
+}  // namespace api
@@ -0,0 +1,221 @@
+#include "Pass/Common/PassManager.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <unordered_set>
+
+#include "IR/VisitorBase.h"
+#include "Pass/Common/ConstantFold.h"
+#include "Pass/Common/HoistIfThenElse.h"
+#include "Pass/Common/InjectVirtualThread.h"
+#include "Pass/Common/LoopPartition.h"
+#include "Pass/Common/NarrowIndex.h"
+#include "Pass/Common/ScalarReplace.h"
+#include "Pass/Common/StatementSimplify.h"
+#include "Pass/Common/StrengthReduce.h"
+#include "Pass/Common/Unroll.h"
+#include "Pass/Hardware/SimdVectorize.h"
+#include "logging.h"
+
+namespace {
+class NodeCounter : public VisitorBase<NodeCounter> {
+ public:
+  // Children are often held through typed pointers (e.g. For::it), which
+  // bypass the 'visit(Node*)' dispatcher, so hook every concrete type.
+  // Shared subtrees are counted (and walked) only once.
+#define IR_NODE_TYPE_PLAIN(Type)                            \
+  void visit(ir::Type* node) {                              \
+    if (seen.insert(node).second) VisitorBase::visit(node); \
+  }
+#define IR_NODE_TYPE_ABSTRACT(Type)
+#define IR_NODE_TYPE_NESTED(Type)                           \
+  template <typename T>                                     \
+  void visit(ir::Type<T>* node) {                           \
+    if (seen.insert(node).second) VisitorBase::visit(node); \
+  }
+#include "x/ir_node_types.def"
+  using VisitorBase::visit;
+
+  std::unordered_set<const ir::Node*> seen;
+};
+
+uint64_t measureContext(const LoweringContext& ctx) {
+  if (ctx.stmt) return api::countNodes(ctx.stmt);
+  if (ctx.schedule) return api::countNodes(ctx.schedule);
+  return 0;
+}
+}  // namespace
+
+namespace api {
+uint64_t countNodes(ir::NodePtr node) {
+  NodeCounter counter;
+  counter.visit(node.get());
+  return counter.seen.size();
+}
+
+int64_t peakMemoryKB() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+  // macOS reports bytes, Linux reports KiB.
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+}  // namespace api
+
+const char* PassManager::defaultPipeline() {
+  return "normalize,inferBound,scheduleToStatement,flattenStorage,"
+         "rewriteStorage,autoUnroll,unrollPartial,foldConstants,narrowIndex,"
+         "partitionLoops,vectorizeLoops,replaceScalars,reduceInductionVars,foldConstants,"
+         "reduceDivMod";
+}
+
+PassManager::PassManager() {
+  registerPass("normalize", [](LoweringContext* ctx) {
+    ELENA_ASSERT(ctx->schedule, "normalize requires a schedule");
+    ctx->schedule = ctx->schedule->normalize();
+  });
+  registerPass("inferBound", [](LoweringContext* ctx) {
+    ELENA_ASSERT(ctx->schedule, "inferBound requires a schedule");
+    ctx->bound = api::inferBound(ctx->schedule);
+  });
+  registerPass("scheduleToStatement", [](LoweringContext* ctx) {
+    ELENA_ASSERT(ctx->schedule && ctx->bound,
+                 "scheduleToStatement requires inferBound");
+    ctx->stmt = api::scheduleToStatement(ctx->schedule, ctx->bound);
+  });
+  registerPass("flattenStorage", [](LoweringContext* ctx) {
+    ELENA_ASSERT(ctx->stmt && ctx->bound,
+                 "flattenStorage requires scheduleToStatement");
+    ctx->stmt = api::flattenStorage(ctx->stmt, ctx->bound);
+  });
+
+  // Passes that only rewrite the statement.
+  auto stmt_pass = [](std::function<ir::StmtPtr(ir::StmtPtr)> func) {
+    return [func](LoweringContext* ctx) {
+      ELENA_ASSERT(ctx->stmt, "pass requires scheduleToStatement");
+      ctx->stmt = func(ctx->stmt);
+    };
+  };
+  registerPass("rewriteStorage", stmt_pass(api::rewriteStorage));
+  registerPass("autoUnroll", stmt_pass([](ir::StmtPtr stmt) {
+                 return api::autoUnroll(stmt, false);
+               }));
+  registerPass("unrollFull", stmt_pass(api::unrollFull));
+  registerPass("unrollPartial", stmt_pass(api::unrollPartial));
+  registerPass("foldConstants", stmt_pass(api::foldConstants));
+  registerPass("narrowIndex", [](LoweringContext* ctx) {
+    ELENA_ASSERT(ctx->stmt, "narrowIndex requires scheduleToStatement");
+    ctx->stmt = api::narrowIndex(ctx->stmt, ctx->var_max);
+  });
+  registerPass("partitionLoops", stmt_pass(api::partitionLoops));
+  registerPass("vectorizeLoops", [](LoweringContext* ctx) {
+    ELENA_ASSERT(ctx->stmt, "vectorizeLoops requires scheduleToStatement");
+    if (ctx->vectorize) ctx->stmt = api::vectorizeLoops(ctx->stmt);
+  });
+  registerPass("replaceScalars", stmt_pass(api::replaceScalars));
+  registerPass("reduceInductionVars", stmt_pass(api::reduceInductionVars));
+  registerPass("reduceDivMod", stmt_pass(api::reduceDivMod));
+  registerPass("simplify", stmt_pass([](ir::StmtPtr stmt) {
+                 return api::simplify(stmt);
+               }));
+  registerPass("simplifyStatement", stmt_pass(api::simplifyStatement));
+  registerPass("hoistIfThenElse", stmt_pass(api::hoistIfThenElse));
+  registerPass("injectVirtualThread", stmt_pass(api::injectVirtualThread));
+
+  setPipeline(defaultPipeline());
+}
+
+void PassManager::registerPass(const std::string& name, PassFunc func) {
+  registry_[name] = func;
+}
+
+void PassManager::addPass(const std::string& name) {
+  if (!registry_.count(name)) {
+    std::ostringstream known;
+    for (const auto& kv : registry_) known << " " << kv.first;
+    ELENA_ABORT("Unknown pass '" << name << "', registered passes:"
+                                 << known.str());
+  }
+  pipeline_.push_back(name);
+}
+
+void PassManager::setPipeline(const std::string& pipeline) {
+  pipeline_.clear();
+  std::istringstream is(pipeline);
+  std::string name;
+  while (std::getline(is, name, ',')) {
+    if (!name.empty()) addPass(name);
+  }
+}
+
+void PassManager::run(LoweringContext* ctx) {
+  for (const auto& name : pipeline_) {
+    PassStatistics stat;
+    stat.name = name;
+    stat.run = runs_;
+    stat.nodes_before = collect_ ? measureContext(*ctx) : 0;
+
+    auto start = std::chrono::steady_clock::now();
+    registry_.at(name)(ctx);
+    auto end = std::chrono::steady_clock::now();
+
+    stat.wall_ms =
+        std::chrono::duration<double, std::milli>(end - start).count();
+    stat.nodes_after = collect_ ? measureContext(*ctx) : 0;
+    stat.peak_rss_kb = api::peakMemoryKB();
+    stats_.push_back(stat);
+  }
+  ++runs_;
+}
+
+void PassManager::printSummary(std::ostream& os) const {
+  // Aggregate per pass name, keeping the order of first appearance.
+  std::vector<PassStatistics> total;
+  std::unordered_map<std::string, size_t> index;
+  double total_ms = 0;
+  for (const auto& stat : stats_) {
+    total_ms += stat.wall_ms;
+    auto iter = index.find(stat.name);
+    if (iter == index.end()) {
+      index[stat.name] = total.size();
+      total.push_back(stat);
+      continue;
+    }
+    auto& acc = total[iter->second];
+    acc.wall_ms += stat.wall_ms;
+    acc.nodes_before += stat.nodes_before;
+    acc.nodes_after += stat.nodes_after;
+    acc.peak_rss_kb = std::max(acc.peak_rss_kb, stat.peak_rss_kb);
+  }
+
+  os << "===------------------------------------------------------------===\n"
+     << "                    ... Pass execution timing report ...\n"
+     << "===------------------------------------------------------------===\n"
+     << "  Total Execution Time: " << std::fixed << std::setprecision(3)
+     << total_ms << " ms (" << runs_ << " pipeline runs)\n\n"
+     << std::setw(12) << "Wall (ms)" << std::setw(8) << "%" << std::setw(14)
+     << "Nodes before" << std::setw(14) << "Nodes after" << std::setw(16)
+     << "Peak RSS (KiB)"
+     << "  Pass\n";
+  for (const auto& stat : total) {
+    os << std::setw(12) << std::setprecision(3) << stat.wall_ms << std::setw(8)
+       << std::setprecision(1)
+       << (total_ms > 0 ? 100.0 * stat.wall_ms / total_ms : 0.0);
+    if (collect_) {
+      os << std::setw(14) << stat.nodes_before << std::setw(14)
+         << stat.nodes_after;
+    } else {
+      os << std::setw(14) << "-" << std::setw(14) << "-";
+    }
+    os << std::setw(16) << stat.peak_rss_kb << "  " << stat.name << "\n";
+  }
+  os.unsetf(std::ios_base::floatfield);
+  os << std::setprecision(6);
+}
@@ -0,0 +1,1009 @@
+#include "Pass/Common/ScalarReplace.h"
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "IR/ExprEqual.h"
+#include "Pass/Common/StmtCopy.h"
+#include "api.h"
+
+namespace {
+using Guards = std::vector<ir::ExprPtr>;
+
+bool readInteger(const ir::ExprPtr &expr, int64_t *value) {
+  if (expr->get_type() != ir::IRNodeType::Const) return false;
+  switch (expr->get_dtype()) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type)          \
+  case ir::ScalarType::scalar_type:                                      \
+    *value = static_cast<int64_t>(                                       \
+        static_cast<Const<native_type> *>(expr.get())->get_value());     \
+    return true;
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return false;
+  }
+}
+
+ir::ExprPtr makeConst(int64_t value, ir::ScalarType dtype) {
+  switch (dtype) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type) \
+  case ir::ScalarType::scalar_type:                             \
+    return std::make_shared<Const<native_type>>(                \
+        static_cast<native_type>(value), dtype);
+#include "x/scalar_types.def"
+    default:
+      return nullptr;
+  }
+}
+
+ir::TensorVarPtr makeRegister(ir::ScalarType dtype, const std::string &name) {
+  ir::Array<ir::Expr> shape{
+      std::make_shared<Const<uint64_t>>(1, ir::ScalarType::UInt64)};
+  switch (dtype) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type) \
+  case ir::ScalarType::scalar_type:                             \
+    return api::placeholder<native_type>(shape, name);
+#include "x/scalar_types.def"
+    default:
+      return nullptr;
+  }
+}
+
+/// Constants print as literals, which C promotes to the type of the other
+/// operand as long as they fit an int.
+bool literal(const ir::ExprPtr &expr) {
+  int64_t value;
+  return readInteger(expr, &value) && value >= 0 && value <= INT32_MAX;
+}
+
+/// Whether C computes 'expr' in 'dtype' (given its IR type, which is only
+/// the type of the left operand of a binary node).
+bool hasType(const ir::ExprPtr &expr, ir::ScalarType dtype) {
+  if (literal(expr)) return true;
+  switch (expr->get_type()) {
+    case ir::IRNodeType::Binary: {
+      auto binary = ir::ptr_cast<ir::Binary>(expr);
+      if (literal(binary->lhs)) return hasType(binary->rhs, dtype);
+      return binary->get_dtype() == dtype && hasType(binary->lhs, dtype) &&
+             hasType(binary->rhs, dtype);
+    }
+    case ir::IRNodeType::Unary:
+      return hasType(ir::ptr_cast<ir::Unary>(expr)->operand, dtype);
+    default:
+      return expr->get_dtype() == dtype;
+  }
+}
+
+/// Whether two lists of guards test the same conditions.  Scheduling wraps
+/// every store in its own copy of a guard, e.g. the three channel stores of
+/// a padded pixel, so comparing the nodes would never match.
+bool sameGuards(const Guards &a, const Guards &b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i] != b[i] && !ir::exprEqual(a[i].get(), b[i].get())) return false;
+  }
+  return true;
+}
+
+/// The operands of a chain of '&' or '&&'.
+void conjuncts(const ir::ExprPtr &cond, Guards *terms) {
+  if (cond->get_type() == ir::IRNodeType::Binary &&
+      ir::ptr_cast<ir::Binary>(cond)->operation_type == ir::BinaryType::And) {
+    auto binary = ir::ptr_cast<ir::Binary>(cond);
+    conjuncts(binary->lhs, terms);
+    conjuncts(binary->rhs, terms);
+  } else if (cond->get_type() == ir::IRNodeType::Logical &&
+             ir::ptr_cast<ir::Logical>(cond)->operation_type ==
+                 ir::LogicalType::AND) {
+    auto logical = ir::ptr_cast<ir::Logical>(cond);
+    conjuncts(logical->lhs, terms);
+    conjuncts(logical->rhs, terms);
+  } else if (cond->get_type() != ir::IRNodeType::Const ||
+             cond->get_dtype() != ir::ScalarType::Boolean ||
+             !ir::ptr_cast<ir::Const<bool>>(cond)->get_value()) {
+    // skips the 'true' api::logical::all starts from.
+    terms->push_back(cond);
+  }
+}
+
+/// A load 'tensor[sum(terms) + offset + stride * it]' of an innermost loop.
+struct Access {
+  ir::ScalarVarPtr load;
+  // statements evaluating the load, in the order they were found.
+  std::vector<const ir::Stmt *> stmts;
+  bool uniform{true};
+  // the selects whose then branch holds the load, see LoopScan::contexts_.
+  size_t context{0};
+  // the load is only evaluated by the iterations passing some tests.
+  bool conditional{false};
+  // conditions (not depending on the loop variable) the load is under.
+  Guards guards;
+  int64_t stride{0};
+  int64_t offset{0};
+  std::vector<std::pair<int64_t, ir::ExprPtr>> terms;
+};
+
+/// Finds the loads of an innermost loop that are candidates for scalar
+/// replacement.
+class LoopScan {
+ public:
+  explicit LoopScan(const ir::For *loop)
+      : loop_(loop), name_(loop->it->get_name()) {}
+
+  /// False if the body has statements the pass does not handle, e.g.
+  /// nested loops or calls with side effects.
+  bool scan() {
+    Guards guards;
+    if (!stmt(loop_->body, &guards)) return false;
+    for (auto &access : accesses_) {
+      if (analyze(&access)) accesses.push_back(access);
+    }
+    return true;
+  }
+
+  /// Loads replaceable by a register, with their index decomposed.
+  std::vector<Access> accesses;
+
+ private:
+  bool stmt(const ir::StmtPtr &node, Guards *guards) {
+    if (!node) return true;
+    switch (node->get_type()) {
+      case ir::IRNodeType::Block: {
+        auto block = ir::ptr_cast<ir::Block>(node);
+        return stmt(block->head, guards) && stmt(block->tail, guards);
+      }
+      case ir::IRNodeType::IfThenElse: {
+        auto branch = ir::ptr_cast<ir::IfThenElse>(node);
+        guards_[node.get()] = *guards;
+        expr(branch->condition, node.get(), true);
+        guards->push_back(branch->condition);
+        bool ok = stmt(branch->then_case, guards);
+        guards->pop_back();
+        // registers are rotated under the guards of their loads, which
+        // can not express an else branch.
+        ++in_else_;
+        ok = ok && stmt(branch->else_case, guards);
+        --in_else_;
+        return ok;
+      }
+      case ir::IRNodeType::Let: {
+        auto let = ir::ptr_cast<ir::Let>(node);
+        declared_.insert(let->var->get_name());
+        guards_[node.get()] = *guards;
+        expr(let->value, node.get(), true);
+        return stmt(let->body, guards);
+      }
+      case ir::IRNodeType::Allocate: {
+        auto allocate = ir::ptr_cast<ir::Allocate>(node);
+        stored_.insert(allocate->var.get());
+        return stmt(allocate->body, guards);
+      }
+      case ir::IRNodeType::Store: {
+        auto store = ir::ptr_cast<ir::Store>(node);
+        stored_.insert(store->var.get());
+        guards_[node.get()] = *guards;
+        expr(store->value, node.get(), true);
+        for (auto &index : store->index->element) {
+          expr(index, node.get(), true);
+        }
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  void expr(const ir::ExprPtr &node, const ir::Stmt *stmt, bool uniform) {
+    if (!node) return;
+    uniform = uniform && in_else_ == 0;
+    // every (node, statement, context, uniform) once, shared subtrees are
+    // common.
+    auto &mask = seen_[Visit{node.get(), stmt, context_}];
+    if (mask & (uniform ? 1 : 2)) return;
+    mask |= uniform ? 1 : 2;
+    switch (node->get_type()) {
+      case ir::IRNodeType::ScalarVar: {
+        auto load = ir::ptr_cast<ir::ScalarVar>(node);
+        if (load->is_placeholder()) break;
+        auto found = index_.find(node.get());
+        if (found == index_.end()) {
+          found = index_.emplace(node.get(), accesses_.size()).first;
+          accesses_.emplace_back();
+          accesses_.back().load = load;
+          accesses_.back().context = context_;
+        }
+        auto &access = accesses_[found->second];
+        access.uniform =
+            access.uniform && uniform && access.context == context_;
+        if (access.stmts.empty() || access.stmts.back() != stmt) {
+          access.stmts.push_back(stmt);
+        }
+        for (auto &index : load->indices->element) expr(index, stmt, uniform);
+        break;
+      }
+      case ir::IRNodeType::Select: {
+        auto select = ir::ptr_cast<ir::Select>(node);
+        expr(select->cond, stmt, uniform);
+        // the then branch is evaluated under the condition, which is sorted
+        // out once the whole body is known.
+        auto outer = context_;
+        if (uniform) {
+          Guards conds = contexts_[outer];
+          conds.push_back(select->cond);
+          context_ = 0;
+          while (context_ < contexts_.size() &&
+                 !sameGuards(contexts_[context_], conds)) {
+            ++context_;
+          }
+          if (context_ == contexts_.size()) contexts_.push_back(conds);
+        }
+        expr(select->tBranch, stmt, uniform);
+        context_ = outer;
+        expr(select->fBranch, stmt, false);
+        break;
+      }
+      case ir::IRNodeType::Logical: {
+        auto logical = ir::ptr_cast<ir::Logical>(node);
+        bool lazy = logical->operation_type == ir::LogicalType::AND ||
+                    logical->operation_type == ir::LogicalType::OR;
+        expr(logical->lhs, stmt, uniform);
+        expr(logical->rhs, stmt, uniform && !lazy);
+        break;
+      }
+      case ir::IRNodeType::Binary: {
+        auto binary = ir::ptr_cast<ir::Binary>(node);
+        expr(binary->lhs, stmt, uniform);
+        expr(binary->rhs, stmt, uniform);
+        break;
+      }
+      case ir::IRNodeType::Unary:
+        expr(ir::ptr_cast<ir::Unary>(node)->operand, stmt, uniform);
+        break;
+      case ir::IRNodeType::Cast:
+        expr(ir::ptr_cast<ir::Cast>(node)->expr_, stmt, uniform);
+        break;
+      case ir::IRNodeType::Call: {
+        // only the arguments evaluated once per call are as uniform as the
+        // call, a Body runs for every binding and an Address is no value.
+        auto call = ir::ptr_cast<ir::Call>(node);
+        for (size_t i = 0; i < call->args->element.size(); ++i) {
+          auto &arg = call->args->element[i];
+          switch (call->arg_type(i)) {
+            case ir::CallArgType::Binder:
+              declared_.insert(ir::ptr_cast<ir::IterVar>(arg)->get_name());
+              break;
+            case ir::CallArgType::Value:
+              expr(arg, stmt, uniform);
+              break;
+            default:
+              expr(arg, stmt, false);
+              break;
+          }
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  bool analyze(Access *access) {
+    auto load = access->load;
+    if (!access->uniform || stored_.count(load->tensor.get()) ||
+        load->indices->element.size() != 1) {
+      return false;
+    }
+    // registers are written and rotated under one set of conditions.
+    auto &guards = guards_.at(access->stmts.front());
+    for (auto stmt : access->stmts) {
+      if (!sameGuards(guards_.at(stmt), guards)) return false;
+    }
+    for (auto &guard : guards) {
+      if (isBoundCheck(guard)) continue;
+      if (!invariant(guard)) return false;
+      access->guards.push_back(guard);
+    }
+    // a select testing the row and the column of a padded pixel: the tests
+    // of the row guard the load like an if, while the iterations passing
+    // the tests of the column are not known before the loop.  Those tests
+    // only bound the indices that depend on the loop variable, so a load
+    // that does not is still valid under the others and can be hoisted.
+    for (auto &cond : contexts_[access->context]) {
+      Guards terms;
+      conjuncts(cond, &terms);
+      for (auto &term : terms) {
+        if (invariant(term)) {
+          access->guards.push_back(term);
+        } else {
+          access->conditional = true;
+        }
+      }
+    }
+    auto &index = load->indices->element[0];
+    if (!linear(index, 1, index->get_dtype(), access)) return false;
+    if (access->conditional && access->stride != 0) return false;
+    // merge equal terms.
+    std::vector<std::pair<int64_t, ir::ExprPtr>> terms;
+    for (auto &term : access->terms) {
+      bool merged = false;
+      for (auto &other : terms) {
+        if (ir::exprEqual(other.second.get(), term.second.get())) {
+          other.first += term.first;
+          merged = true;
+          break;
+        }
+      }
+      if (!merged) terms.push_back(term);
+    }
+    access->terms.clear();
+    for (auto &term : terms) {
+      if (term.first != 0) access->terms.push_back(term);
+    }
+    return true;
+  }
+
+  /// Decomposes 'scale * expr' into the terms of 'access'.
+  bool linear(const ir::ExprPtr &expr, int64_t scale, ir::ScalarType dtype,
+              Access *access) {
+    int64_t value;
+    if (readInteger(expr, &value)) {
+      access->offset += scale * value;
+      return true;
+    }
+    if (expr->get_type() == ir::IRNodeType::IterVar &&
+        ir::ptr_cast<ir::IterVar>(expr)->get_name() == name_) {
+      access->stride += scale;
+      return expr->get_dtype() == dtype;
+    }
+    if (invariant(expr)) {
+      access->terms.emplace_back(scale, expr);
+      return hasType(expr, dtype);
+    }
+    if (expr->get_type() != ir::IRNodeType::Binary) return false;
+    auto binary = ir::ptr_cast<ir::Binary>(expr);
+    if (!literal(binary->lhs) && binary->get_dtype() != dtype) return false;
+    switch (binary->operation_type) {
+      case ir::BinaryType::Add:
+        return linear(binary->lhs, scale, dtype, access) &&
+               linear(binary->rhs, scale, dtype, access);
+      case ir::BinaryType::Sub:
+        return linear(binary->lhs, scale, dtype, access) &&
+               linear(binary->rhs, -scale, dtype, access);
+      case ir::BinaryType::Mul:
+        if (readInteger(binary->lhs, &value)) {
+          return linear(binary->rhs, scale * value, dtype, access);
+        }
+        if (readInteger(binary->rhs, &value)) {
+          return linear(binary->lhs, scale * value, dtype, access);
+        }
+        return false;
+      default:
+        return false;
+    }
+  }
+
+  /// Whether 'expr' has the same value in every iteration.  Loads are, if
+  /// the loop does not store to the tensor.
+  bool invariant(const ir::ExprPtr &expr) {
+    auto cached = invariant_.find(expr.get());
+    if (cached != invariant_.end()) return cached->second;
+    bool res = false;
+    switch (expr->get_type()) {
+      case ir::IRNodeType::Const:
+        res = true;
+        break;
+      case ir::IRNodeType::IterVar: {
+        auto &name = ir::ptr_cast<ir::IterVar>(expr)->get_name();
+        res = name != name_ && !declared_.count(name);
+        break;
+      }
+      case ir::IRNodeType::ScalarVar: {
+        auto var = ir::ptr_cast<ir::ScalarVar>(expr);
+        if (var->is_placeholder()) {
+          res = !declared_.count(var->get_name());
+        } else {
+          res = !stored_.count(var->tensor.get());
+          for (auto &index : var->indices->element) {
+            res = res && invariant(index);
+          }
+        }
+        break;
+      }
+      case ir::IRNodeType::Binary: {
+        auto binary = ir::ptr_cast<ir::Binary>(expr);
+        res = invariant(binary->lhs) && invariant(binary->rhs);
+        break;
+      }
+      case ir::IRNodeType::Logical: {
+        auto logical = ir::ptr_cast<ir::Logical>(expr);
+        res = invariant(logical->lhs) && invariant(logical->rhs);
+        break;
+      }
+      case ir::IRNodeType::Unary:
+        res = invariant(ir::ptr_cast<ir::Unary>(expr)->operand);
+        break;
+      case ir::IRNodeType::Cast:
+        res = invariant(ir::ptr_cast<ir::Cast>(expr)->expr_);
+        break;
+      case ir::IRNodeType::Select: {
+        auto select = ir::ptr_cast<ir::Select>(expr);
+        res = invariant(select->cond) && invariant(select->tBranch) &&
+              invariant(select->fBranch);
+        break;
+      }
+      default:
+        break;
+    }
+    invariant_[expr.get()] = res;
+    return res;
+  }
+
+  /// 'it < init + extent', or 'it < extent' once a zero 'init' is folded,
+  /// true in every iteration.
+  bool isBoundCheck(const ir::ExprPtr &cond) {
+    if (cond->get_type() != ir::IRNodeType::Logical) return false;
+    auto logical = ir::ptr_cast<ir::Logical>(cond);
+    if (logical->operation_type != ir::LogicalType::LT ||
+        logical->lhs->get_type() != ir::IRNodeType::IterVar ||
+        ir::ptr_cast<ir::IterVar>(logical->lhs)->get_name() != name_ ||
+        !invariant(loop_->init) || !invariant(loop_->extent)) {
+      return false;
+    }
+    int64_t init;
+    if (readInteger(loop_->init, &init) && init == 0 &&
+        ir::exprEqual(logical->rhs.get(), loop_->extent.get())) {
+      return true;
+    }
+    if (logical->rhs->get_type() != ir::IRNodeType::Binary) return false;
+    auto bound = ir::ptr_cast<ir::Binary>(logical->rhs);
+    return bound->operation_type == ir::BinaryType::Add &&
+           ir::exprEqual(bound->lhs.get(), loop_->init.get()) &&
+           ir::exprEqual(bound->rhs.get(), loop_->extent.get());
+  }
+
+  const ir::For *loop_;
+  std::string name_;
+  std::vector<Access> accesses_;
+  std::unordered_map<const ir::Node *, size_t> index_;
+  std::unordered_map<const ir::Node *, Guards> guards_;
+  std::unordered_set<const ir::Node *> stored_;
+  std::unordered_set<std::string> declared_;
+  std::unordered_map<const ir::Node *, bool> invariant_;
+  // the conditions of the selects an expression is in the then branch of,
+  // 0 for none.
+  std::vector<Guards> contexts_{Guards()};
+  size_t context_{0};
+  struct Visit {
+    const ir::Node *node;
+    const ir::Stmt *stmt;
+    size_t context;
+    bool operator==(const Visit &other) const {
+      return node == other.node && stmt == other.stmt &&
+             context == other.context;
+    }
+  };
+  struct VisitHash {
+    size_t operator()(const Visit &v) const {
+      return (std::hash<const void *>()(v.node) * 31 +
+              std::hash<const void *>()(v.stmt)) *
+                 31 +
+             v.context;
+    }
+  };
+  std::unordered_map<Visit, int, VisitHash> seen_;
+  int in_else_{0};
+};
+
+bool sameBase(const Access &a, const Access &b) {
+  if (a.load->tensor != b.load->tensor || a.stride != b.stride ||
+      !sameGuards(a.guards, b.guards) || a.terms.size() != b.terms.size()) {
+    return false;
+  }
+  for (auto &term : a.terms) {
+    bool found = false;
+    for (auto &other : b.terms) {
+      if (term.first == other.first &&
+          ir::exprEqual(term.second.get(), other.second.get())) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) return false;
+  }
+  return true;
+}
+
+/// Values several consecutive stores of a loop body compute, e.g. the
+/// resized gray pixel every channel of GRAY2BGR reads, computed once into a
+/// register in front of the first store evaluating them unconditionally.
+class ValueSharer {
+ public:
+  explicit ValueSharer(int *registers) : registers_(registers) {}
+
+  ir::StmtPtr share(const ir::StmtPtr &body) {
+    std::vector<ir::StmtPtr> stmts;
+    flatten(body, &stmts);
+    std::vector<ir::StmtPtr> res;
+    for (size_t begin = 0, end = 0; begin < stmts.size(); begin = end) {
+      end = begin;
+      while (end < stmts.size() &&
+             stmts[end]->get_type() == ir::IRNodeType::Store) {
+        ++end;
+      }
+      if (end == begin) {
+        res.push_back(stmts[end++]);
+      } else {
+        shareRun(stmts, begin, end, &res);
+      }
+    }
+    if (registers.empty()) return body;
+    ir::StmtPtr block;
+    for (auto stmt = res.rbegin(); stmt != res.rend(); ++stmt) {
+      block = block ? std::make_shared<ir::Block>(*stmt, block) : *stmt;
+    }
+    return block;
+  }
+
+  /// The registers written by the shared body.
+  std::vector<ir::TensorVarPtr> registers;
+
+ private:
+  static void flatten(const ir::StmtPtr &stmt,
+                      std::vector<ir::StmtPtr> *stmts) {
+    if (stmt->get_type() == ir::IRNodeType::Block) {
+      auto block = ir::ptr_cast<ir::Block>(stmt);
+      flatten(block->head, stmts);
+      if (block->tail) flatten(block->tail, stmts);
+    } else {
+      stmts->push_back(stmt);
+    }
+  }
+
+  void shareRun(const std::vector<ir::StmtPtr> &stmts, size_t begin,
+                size_t end, std::vector<ir::StmtPtr> *res) {
+    stored_.clear();
+    subst_.clear();
+    trees_.clear();
+    hoisted_.assign(end - begin, {});
+    for (size_t i = begin; i < end; ++i) {
+      auto store = ir::ptr_cast<ir::Store>(stmts[i]);
+      stored_.insert(store->var.get());
+      trees_.emplace_back();
+      std::unordered_set<const ir::Node *> seen;
+      subtrees(store->value, &trees_.back(), &seen);
+    }
+    for (size_t i = begin; i < end; ++i) {
+      walk(ir::ptr_cast<ir::Store>(stmts[i])->value, i - begin);
+    }
+    StmtCowSubstitute subst(subst_);
+    for (size_t i = begin; i < end; ++i) {
+      for (auto &value : hoisted_[i - begin]) {
+        // the value itself may hold values shared by earlier stores.
+        auto inner = subst_;
+        inner.erase(value.second.get());
+        res->push_back(std::make_shared<ir::Store>(
+            value.first, StmtCowSubstitute(inner).substitute(value.second),
+            zero()));
+      }
+      res->push_back(subst.substitute(stmts[i]));
+    }
+  }
+
+  /// Every subtree of a stored value but the indices of its loads, which
+  /// are left to reduceInductionVars.
+  static void subtrees(const ir::ExprPtr &expr, std::vector<ir::ExprPtr> *res,
+                       std::unordered_set<const ir::Node *> *seen) {
+    if (!expr || !seen->insert(expr.get()).second) return;
+    res->push_back(expr);
+    for (auto &child : children(expr, false)) subtrees(child, res, seen);
+  }
+
+  /// The operands of 'expr', only those evaluated whenever 'expr' is if
+  /// 'eager'.
+  static std::vector<ir::ExprPtr> children(const ir::ExprPtr &expr,
+                                           bool eager) {
+    switch (expr->get_type()) {
+      case ir::IRNodeType::Binary: {
+        auto binary = ir::ptr_cast<ir::Binary>(expr);
+        return {binary->lhs, binary->rhs};
+      }
+      case ir::IRNodeType::Logical: {
+        auto logical = ir::ptr_cast<ir::Logical>(expr);
+        if (eager && (logical->operation_type == ir::LogicalType::AND ||
+                      logical->operation_type == ir::LogicalType::OR)) {
+          return {logical->lhs};
+        }
+        return {logical->lhs, logical->rhs};
+      }
+      case ir::IRNodeType::Unary:
+        return {ir::ptr_cast<ir::Unary>(expr)->operand};
+      case ir::IRNodeType::Cast:
+        return {ir::ptr_cast<ir::Cast>(expr)->expr_};
+      case ir::IRNodeType::Select: {
+        auto select = ir::ptr_cast<ir::Select>(expr);
+        if (eager) return {select->cond};
+        return {select->cond, select->tBranch, select->fBranch};
+      }
+      case ir::IRNodeType::Call: {
+        auto call = ir::ptr_cast<ir::Call>(expr);
+        std::vector<ir::ExprPtr> args;
+        for (size_t i = 0; i < call->args->element.size(); ++i) {
+          if (call->arg_type(i) == ir::CallArgType::Value) {
+            args.push_back(call->args->element[i]);
+          }
+        }
+        return args;
+      }
+      default:
+        return {};
+    }
+  }
+
+  /// Operations outside of load indices, -1 if 'expr' reads a tensor the
+  /// stores write.  A call iterates a window, its arguments but the binders
+  /// count as well.  Loads count as well, a value without any is left to the
+  /// C compiler.  'calls' is set if 'expr' holds a call, which exprEqual
+  /// cannot compare.
+  int cost(const ir::ExprPtr &expr, bool *loads, bool *calls) {
+    if (expr->get_type() == ir::IRNodeType::ScalarVar) {
+      auto var = ir::ptr_cast<ir::ScalarVar>(expr);
+      if (var->is_placeholder()) return 0;
+      *loads = true;
+      return stored_.count(var->tensor.get()) ? -1 : 0;
+    }
+    if (expr->get_type() == ir::IRNodeType::Call) {
+      auto call = ir::ptr_cast<ir::Call>(expr);
+      *calls = true;
+      int res = 2;
+      for (size_t i = 0; i < call->args->element.size(); ++i) {
+        if (call->arg_type(i) == ir::CallArgType::Binder) continue;
+        int c = cost(call->args->element[i], loads, calls);
+        if (c < 0) return -1;
+        res += c;
+      }
+      return res;
+    }
+    int res = expr->get_type() == ir::IRNodeType::Binary ||
+              expr->get_type() == ir::IRNodeType::Unary ||
+              expr->get_type() == ir::IRNodeType::Select;
+    for (auto &child : children(expr, false)) {
+      int c = cost(child, loads, calls);
+      if (c < 0) return -1;
+      res += c;
+    }
+    return res;
+  }
+
+  void walk(const ir::ExprPtr &expr, size_t i) {
+    if (subst_.count(expr.get())) return;
+    bool loads = false, calls = false;
+    if (expr->get_type() != ir::IRNodeType::ScalarVar &&
+        cost(expr, &loads, &calls) >= 2 && loads &&
+        hasType(expr, expr->get_dtype())) {
+      std::vector<ir::ExprPtr> matches;
+      for (size_t j = i; j < trees_.size(); ++j) {
+        for (auto &tree : trees_[j]) {
+          // the channels of a gray pixel usually share the node itself.
+          if (tree == expr ? j > i
+                           : !calls &&
+                                 tree->get_type() == expr->get_type() &&
+                                 tree->get_dtype() == expr->get_dtype() &&
+                                 !subst_.count(tree.get()) &&
+                                 ir::exprEqual(tree.get(), expr.get())) {
+            matches.push_back(tree);
+          }
+        }
+      }
+      if (!matches.empty()) {
+        auto reg = makeRegister(expr->get_dtype(),
+                                "reuse" + std::to_string((*registers_)++));
+        registers.push_back(reg);
+        auto load = std::make_shared<ir::ScalarVar>(reg, zero());
+        subst_[expr.get()] = load;
+        for (auto &match : matches) subst_[match.get()] = load;
+        hoisted_[i].emplace_back(reg, expr);
+        return;
+      }
+    }
+    for (auto &child : children(expr, true)) walk(child, i);
+  }
+
+  static ir::ArrayPtr<ir::Expr> zero() {
+    return std::make_shared<ir::Array<ir::Expr>>(
+        std::vector<ir::ExprPtr>{
+            std::make_shared<Const<uint64_t>>(0, ir::ScalarType::UInt64)});
+  }
+
+  int *registers_;
+  std::unordered_set<const ir::Node *> stored_;
+  std::unordered_map<const ir::Node *, ir::NodePtr> subst_;
+  // the subtrees of every store of the run.
+  std::vector<std::vector<ir::ExprPtr>> trees_;
+  // the registers each store of the run writes first.
+  std::vector<std::vector<std::pair<ir::TensorVarPtr, ir::ExprPtr>>> hoisted_;
+};
+
+/// Registers of a chain of loads 'A[f(i)]', 'A[f(i) + s]', ..., register 'k'
+/// holding 'A[f(i) + k * s]'.
+struct Chain {
+  std::vector<ir::TensorVarPtr> regs;
+  // one of the loads each register replaces.
+  std::vector<ir::ExprPtr> loads;
+  Guards guards;
+};
+
+/// Rebuilds the statements of a loop body, loads replaced by registers and
+/// register loads inserted in front of the statements using them.
+class BodyRewriter {
+ public:
+  BodyRewriter(const std::unordered_map<const ir::Node *, ir::NodePtr> &loads,
+               const std::unordered_map<
+                   const ir::Stmt *,
+                   std::vector<std::pair<ir::TensorVarPtr, ir::ExprPtr>>>
+                   &prefix)
+      : subst_(loads), prefix_(prefix) {}
+
+  ir::StmtPtr rewrite(const ir::StmtPtr &node) {
+    if (!node) return node;
+    ir::StmtPtr res;
+    switch (node->get_type()) {
+      case ir::IRNodeType::Block: {
+        auto block = ir::ptr_cast<ir::Block>(node);
+        return std::make_shared<ir::Block>(rewrite(block->head),
+                                           rewrite(block->tail));
+      }
+      case ir::IRNodeType::IfThenElse: {
+        auto branch = ir::ptr_cast<ir::IfThenElse>(node);
+        res = std::make_shared<ir::IfThenElse>(
+            subst_.substitute(branch->condition), rewrite(branch->then_case),
+            rewrite(branch->else_case));
+        break;
+      }
+      case ir::IRNodeType::Let: {
+        auto let = ir::ptr_cast<ir::Let>(node);
+        res = std::make_shared<ir::Let>(
+            let->var, subst_.substitute(let->value), rewrite(let->body));
+        break;
+      }
+      case ir::IRNodeType::Allocate: {
+        auto allocate = std::make_shared<ir::Allocate>(
+            *ir::ptr_cast<ir::Allocate>(node));
+        allocate->body = rewrite(allocate->body);
+        return allocate;
+      }
+      case ir::IRNodeType::Store: {
+        auto store = ir::ptr_cast<ir::Store>(node);
+        auto index = std::make_shared<ir::Array<ir::Expr>>();
+        for (auto &i : store->index->element) {
+          index->element.push_back(subst_.substitute(i));
+        }
+        res = std::make_shared<ir::Store>(
+            store->var, subst_.substitute(store->value), index);
+        break;
+      }
+      default:
+        return node;
+    }
+    auto found = prefix_.find(node.get());
+    if (found == prefix_.end()) return res;
+    for (auto reg = found->second.rbegin(); reg != found->second.rend();
+         ++reg) {
+      res = std::make_shared<ir::Block>(
+          std::make_shared<ir::Store>(reg->first, reg->second, zero()), res);
+    }
+    return res;
+  }
+
+  static ir::ArrayPtr<ir::Expr> zero() {
+    return std::make_shared<ir::Array<ir::Expr>>(
+        std::vector<ir::ExprPtr>{
+            std::make_shared<Const<uint64_t>>(0, ir::ScalarType::UInt64)});
+  }
+
+ private:
+  StmtCowSubstitute subst_;
+  const std::unordered_map<
+      const ir::Stmt *, std::vector<std::pair<ir::TensorVarPtr, ir::ExprPtr>>>
+      &prefix_;
+};
+}  // namespace
+
+ir::NodePtr ScalarReplacer::visit(ir::For *node) {
+  mutate(node->body);
+  auto iter = node->it;
+  auto dtype = iter->get_dtype();
+  if ((node->for_type != ir::ForType::Serial &&
+       node->for_type != ir::ForType::Unrolled) ||
+      (iter->iter_type != ir::IterAttrType::Data &&
+       iter->iter_type != ir::IterAttrType::Unrolled) ||
+      (dtype != ir::ScalarType::UInt32 && dtype != ir::ScalarType::UInt64)) {
+    return node->shared_from_this();
+  }
+  int64_t extent;
+  if (readInteger(node->extent, &extent) && extent == 0) {
+    return node->shared_from_this();
+  }
+  auto zero = BodyRewriter::zero();
+  auto one = std::make_shared<Const<uint64_t>>(1, ir::ScalarType::UInt64);
+  std::vector<ir::TensorVarPtr> registers;
+  auto allocate = [&](ir::StmtPtr res) {
+    for (auto reg = registers.rbegin(); reg != registers.rend(); ++reg) {
+      auto bound = std::make_shared<ir::Array<ir::Range>>();
+      bound->element.push_back(
+          std::make_shared<ir::Range>(zero->element[0], one));
+      res = std::make_shared<ir::Allocate>(*reg, bound, res);
+    }
+    return res;
+  };
+
+  // the shared values are computed into registers first, the loads they
+  // hold are then replaced like the others.
+  ValueSharer sharer(&registers_);
+  auto body = sharer.share(node->body);
+  registers = sharer.registers;
+  auto shared = std::make_shared<ir::For>(*node);
+  shared->body = body;
+  LoopScan scan(shared.get());
+  if (!scan.scan() || scan.accesses.empty()) {
+    if (registers.empty()) return node->shared_from_this();
+    return allocate(shared);
+  }
+
+  std::vector<std::vector<const Access *>> groups;
+  for (auto &access : scan.accesses) {
+    bool found = false;
+    for (auto &group : groups) {
+      if (sameBase(*group.front(), access)) {
+        group.push_back(&access);
+        found = true;
+        break;
+      }
+    }
+    if (!found) groups.push_back({&access});
+  }
+
+  std::vector<Chain> chains;
+  // load -> register, and the registers each statement loads first.
+  std::unordered_map<const ir::Node *, ir::NodePtr> loads;
+  std::unordered_map<const ir::Stmt *,
+                     std::vector<std::pair<ir::TensorVarPtr, ir::ExprPtr>>>
+      prefix;
+  for (auto &group : groups) {
+    auto stride = group.front()->stride;
+    std::set<int64_t> offsets;
+    for (auto access : group) offsets.insert(access->offset);
+    // offset -> (chain, position in the chain).
+    std::unordered_map<int64_t, std::pair<size_t, size_t>> where;
+    for (auto first : offsets) {
+      if (stride != 0 && offsets.count(first - stride)) continue;
+      std::vector<int64_t> chain{first};
+      while (stride != 0 && offsets.count(chain.back() + stride)) {
+        chain.push_back(chain.back() + stride);
+      }
+      // a single load per iteration is not reused.
+      if (stride != 0 && chain.size() < 2) continue;
+      Chain regs;
+      regs.guards = group.front()->guards;
+      for (size_t k = 0; k < chain.size(); ++k) {
+        where[chain[k]] = {chains.size(), k};
+        regs.regs.push_back(
+            makeRegister(group.front()->load->get_dtype(),
+                         "reuse" + std::to_string(registers_++)));
+        regs.loads.push_back(nullptr);
+      }
+      chains.push_back(regs);
+    }
+    for (auto access : group) {
+      auto found = where.find(access->offset);
+      if (found == where.end()) continue;
+      auto &chain = chains[found->second.first];
+      auto k = found->second.second;
+      loads[access->load.get()] =
+          std::make_shared<ir::ScalarVar>(chain.regs[k], zero);
+      chain.loads[k] = access->load;
+      // only the last register of a chain is loaded by the loop.
+      if (stride == 0 || k + 1 < chain.regs.size()) continue;
+      for (auto stmt : access->stmts) {
+        auto &regs = prefix[stmt];
+        bool loaded = false;
+        for (auto &reg : regs) loaded = loaded || reg.first == chain.regs[k];
+        if (!loaded) regs.emplace_back(chain.regs[k], access->load);
+      }
+    }
+  }
+  if (chains.empty()) {
+    if (registers.empty()) return node->shared_from_this();
+    return allocate(shared);
+  }
+
+  // the other registers are filled before the loop, with the values the
+  // first iteration loads.
+  std::unordered_map<std::string, ir::ExprPtr> init{
+      {iter->get_name(), node->init}};
+  StmtCowSubstitute first(init);
+  ir::StmtPtr clear, fill, rotation;
+  auto append = [](ir::StmtPtr *block, ir::StmtPtr stmt) {
+    *block = *block ? std::make_shared<ir::Block>(*block, stmt) : stmt;
+  };
+  // chains under the same conditions share one copy of the guards.
+  std::vector<std::pair<Guards, ir::StmtPtr>> fills, rotations;
+  auto add = [&append](std::vector<std::pair<Guards, ir::StmtPtr>> *blocks,
+                       const Guards &guards, ir::StmtPtr stmt) {
+    for (auto &block : *blocks) {
+      if (sameGuards(block.first, guards)) {
+        append(&block.second, stmt);
+        return;
+      }
+    }
+    blocks->emplace_back(guards, stmt);
+  };
+  auto guard = [&append](const std::vector<std::pair<Guards, ir::StmtPtr>>
+                             &blocks) {
+    ir::StmtPtr res;
+    for (auto &block : blocks) {
+      auto stmt = block.second;
+      for (auto cond = block.first.rbegin(); cond != block.first.rend();
+           ++cond) {
+        stmt = std::make_shared<ir::IfThenElse>(*cond, stmt, nullptr);
+      }
+      append(&res, stmt);
+    }
+    return res;
+  };
+  for (auto &chain : chains) {
+    // the fill is guarded, so without a value the compiler cannot tell the
+    // registers are written before the loop reads them.
+    for (auto &reg : chain.regs) {
+      append(&clear, std::make_shared<ir::Store>(
+                         reg, makeConst(0, reg->get_dtype()), zero));
+    }
+    ir::StmtPtr load, shift;
+    auto last = chain.regs.size() == 1 ? 1 : chain.regs.size() - 1;
+    for (size_t k = 0; k < last; ++k) {
+      append(&load, std::make_shared<ir::Store>(
+                        chain.regs[k], first.substitute(chain.loads[k]), zero));
+    }
+    for (size_t k = 0; k + 1 < chain.regs.size(); ++k) {
+      append(&shift,
+             std::make_shared<ir::Store>(
+                 chain.regs[k],
+                 std::make_shared<ir::ScalarVar>(chain.regs[k + 1], zero),
+                 zero));
+    }
+    add(&fills, chain.guards, load);
+    if (shift) add(&rotations, chain.guards, shift);
+  }
+  fill = guard(fills);
+  rotation = guard(rotations);
+  int64_t value;
+  if (!readInteger(node->extent, &value)) {
+    fill = std::make_shared<ir::IfThenElse>(
+        std::make_shared<ir::Logical>(
+            node->extent, makeConst(0, node->extent->get_dtype()),
+            ir::LogicalType::GT),
+        fill, nullptr);
+  }
+
+  auto loop = std::make_shared<ir::For>(*node);
+  loop->body = BodyRewriter(loads, prefix).rewrite(body);
+  if (rotation) loop->body = std::make_shared<ir::Block>(loop->body, rotation);
+  for (auto &chain : chains) {
+    registers.insert(registers.end(), chain.regs.begin(), chain.regs.end());
+  }
+  return allocate(std::make_shared<ir::Block>(
+      clear, std::make_shared<ir::Block>(fill, loop)));
+}
+
+namespace api {
+ir::StmtPtr replaceScalars(ir::StmtPtr stmt) {
+  ScalarReplacer replacer;
+  return ir::ptr_cast<ir::Stmt>(replacer.visit(stmt.get()));
+}
+}  // namespace api
@@ -25,10 +25,10 @@ NodePtr ExprSimplifier::simplifyNode(NodePtr node) {
 ExprPtr ExprSimplifier::simplifyExpr(Expr* node) {
   if (!node) return nullptr;
   ExprPtr expr;
-  if (expr->get_dtype() == ScalarType::Boolean)
-    expr = BoolSimplifier::simplifyNode(expr.get());
+  if (node->get_dtype() == ScalarType::Boolean)
+    expr = BoolSimplifier::simplifyNode(node);
   else
-    expr = NumericSimplifier::simplifyExpr(expr.get());
+    expr = NumericSimplifier::simplifyExpr(node);
   return expr;
 }
 
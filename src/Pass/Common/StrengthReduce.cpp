@@ -0,0 +1,476 @@
+#include "Pass/Common/StrengthReduce.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "IR/ExprEqual.h"
+#include "Pass/Common/StmtCopy.h"
+#include "api.h"
+#include "logging.h"
+
+namespace {
+using u128 = unsigned __int128;
+
+/// 'q = mulhi(x, m) >> shift' or, when 'add' is set,
+/// 'q = (((x - t) >> 1) + t) >> shift' with 't = mulhi(x, m)'.
+struct Magic {
+  uint64_t m;
+  int shift;
+  bool add;
+};
+
+/// Granlund and Montgomery, "Division by Invariant Integers using
+/// Multiplication", for 'bits'-wide unsigned x and a divisor d that is not a
+/// power of two.
+Magic unsignedMagic(uint64_t d, int bits) {
+  int l = 0;
+  while ((u128(1) << l) < d) ++l;
+  // m = ceil(2^(bits+p) / d) is exact for all x if its error is <= 2^p.
+  for (int p = 0; p < l; ++p) {
+    u128 two = u128(1) << (bits + p);
+    u128 m = (two + d - 1) / d;
+    if ((m >> bits) == 0 && m * d - two <= (u128(1) << p)) {
+      return {static_cast<uint64_t>(m), p, false};
+    }
+  }
+  u128 m = (u128(1) << bits) * ((u128(1) << l) - d) / d + 1;
+  return {static_cast<uint64_t>(m), l - 1, true};
+}
+
+bool readUnsigned(const ir::ExprPtr &expr, uint64_t *value) {
+  if (expr->get_type() != ir::IRNodeType::Const) return false;
+  switch (expr->get_dtype()) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type)           \
+  case ir::ScalarType::scalar_type: {                                     \
+    auto v = static_cast<Const<native_type> *>(expr.get())->get_value();  \
+    if (v < 0) return false;                                              \
+    *value = static_cast<uint64_t>(v);                                    \
+    return true;                                                          \
+  }
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return false;
+  }
+}
+
+ir::ExprPtr makeConst(uint64_t value, ir::ScalarType dtype) {
+  if (dtype == ir::ScalarType::UInt32) {
+    return std::make_shared<Const<uint32_t>>(value, dtype);
+  }
+  return std::make_shared<Const<uint64_t>>(value, dtype);
+}
+
+ir::ExprPtr shiftRight(ir::ExprPtr x, int shift) {
+  if (shift == 0) return x;
+  return std::make_shared<ir::Binary>(
+      x, makeConst(shift, x->get_dtype()), ir::BinaryType::Slr);
+}
+
+/// 'a op b' for op in '+', '-' and '*', folded when it is trivial.
+ir::ExprPtr fold(ir::BinaryType op, ir::ExprPtr a, ir::ExprPtr b) {
+  auto dtype = a->get_dtype();
+  uint64_t x, y;
+  bool const_a = readUnsigned(a, &x), const_b = readUnsigned(b, &y);
+  if (const_a && const_b) {
+    uint64_t v = op == ir::BinaryType::Add   ? x + y
+                 : op == ir::BinaryType::Sub ? x - y
+                                             : x * y;
+    if (dtype == ir::ScalarType::UInt32) v = static_cast<uint32_t>(v);
+    return makeConst(v, dtype);
+  }
+  uint64_t unit = op == ir::BinaryType::Mul ? 1 : 0;
+  if (const_b && y == unit) return a;
+  if (const_a && x == unit && op != ir::BinaryType::Sub) return b;
+  return std::make_shared<ir::Binary>(a, b, op);
+}
+
+/// The index slots of the stores and loads of a loop body, outside of nested
+/// loops, and the names the body declares.
+struct AccessCollector {
+  explicit AccessCollector(const std::unordered_set<const ir::Node *> &offsets)
+      : offsets(offsets) {}
+
+  void stmt(const ir::StmtPtr &node) {
+    if (!node || !seen.insert(node.get()).second) return;
+    switch (node->get_type()) {
+      case ir::IRNodeType::Block: {
+        auto block = ir::ptr_cast<ir::Block>(node);
+        stmt(block->head);
+        stmt(block->tail);
+        break;
+      }
+      case ir::IRNodeType::IfThenElse: {
+        auto branch = ir::ptr_cast<ir::IfThenElse>(node);
+        expr(&branch->condition);
+        stmt(branch->then_case);
+        stmt(branch->else_case);
+        break;
+      }
+      case ir::IRNodeType::Let: {
+        auto let = ir::ptr_cast<ir::Let>(node);
+        declared.insert(let->var->get_name());
+        expr(&let->value);
+        stmt(let->body);
+        break;
+      }
+      case ir::IRNodeType::Attr: {
+        auto attr = ir::ptr_cast<ir::Attr>(node);
+        if (attr->node && attr->node->get_type() == ir::IRNodeType::IterVar) {
+          declared.insert(ir::ptr_cast<ir::IterVar>(attr->node)->get_name());
+        }
+        stmt(attr->body);
+        break;
+      }
+      case ir::IRNodeType::Allocate:
+        stmt(ir::ptr_cast<ir::Allocate>(node)->body);
+        break;
+      case ir::IRNodeType::Evaluate:
+        expr(&ir::ptr_cast<ir::Evaluate>(node)->value);
+        break;
+      case ir::IRNodeType::Store: {
+        auto store = ir::ptr_cast<ir::Store>(node);
+        // the initial value of an inner offset is an index as well.
+        if (offsets.count(store->var.get())) slots.push_back(&store->value);
+        expr(&store->value);
+        for (auto &index : store->index->element) {
+          slots.push_back(&index);
+          expr(&index);
+        }
+        break;
+      }
+      case ir::IRNodeType::For:
+        // runs to completion within one iteration, only its name matters.
+        declared.insert(ir::ptr_cast<ir::For>(node)->it->get_name());
+        break;
+      default:
+        break;
+    }
+  }
+
+  void expr(ir::ExprPtr *slot) {
+    auto node = slot->get();
+    if (!node || !seen.insert(node).second) return;
+    switch (node->get_type()) {
+      case ir::IRNodeType::ScalarVar: {
+        auto load = static_cast<ir::ScalarVar *>(node);
+        if (load->is_placeholder()) break;
+        for (auto &index : load->indices->element) {
+          slots.push_back(&index);
+          expr(&index);
+        }
+        break;
+      }
+      case ir::IRNodeType::Binary:
+        expr(&static_cast<ir::Binary *>(node)->lhs);
+        expr(&static_cast<ir::Binary *>(node)->rhs);
+        break;
+      case ir::IRNodeType::Logical:
+        expr(&static_cast<ir::Logical *>(node)->lhs);
+        expr(&static_cast<ir::Logical *>(node)->rhs);
+        break;
+      case ir::IRNodeType::Unary:
+        expr(&static_cast<ir::Unary *>(node)->operand);
+        break;
+      case ir::IRNodeType::Cast:
+        expr(&static_cast<ir::Cast *>(node)->expr_);
+        break;
+      case ir::IRNodeType::Select:
+        expr(&static_cast<ir::Select *>(node)->cond);
+        expr(&static_cast<ir::Select *>(node)->tBranch);
+        expr(&static_cast<ir::Select *>(node)->fBranch);
+        break;
+      case ir::IRNodeType::Call: {
+        auto call = static_cast<ir::Call *>(node);
+        // the iterators a callee binds are declared by its lambda.
+        for (size_t i = 0; i < call->args->element.size(); ++i) {
+          auto &arg = call->args->element[i];
+          if (call->arg_type(i) == ir::CallArgType::Binder) {
+            declared.insert(ir::ptr_cast<ir::IterVar>(arg)->get_name());
+          } else {
+            expr(&arg);
+          }
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  const std::unordered_set<const ir::Node *> &offsets;
+  std::vector<ir::ExprPtr *> slots;
+  std::unordered_set<std::string> declared;
+  std::unordered_set<const ir::Node *> seen;
+};
+
+/// Decomposes indices as 'base + coefficient * it' for the loop variable 'it'.
+class Affine {
+ public:
+  Affine(const ir::IterVarPtr &it,
+         const std::unordered_set<std::string> &declared)
+      : name_(it->get_name()), dtype_(it->get_dtype()), declared_(declared) {}
+
+  /// The stride of 'index' per iteration if it is affine in the loop variable
+  /// and worth carrying (it multiplies), nullptr otherwise.
+  ir::ExprPtr stride(const ir::ExprPtr &index) {
+    bool affine = true;
+    auto res = coefficient(index, &affine);
+    if (!affine || !multiplies(index)) return nullptr;
+    return res;
+  }
+
+ private:
+  /// Whether 'expr' has the same value in every iteration; loads are not,
+  /// the body may store to the tensor.
+  bool invariant(const ir::ExprPtr &expr) {
+    auto cached = invariant_.find(expr.get());
+    if (cached != invariant_.end()) return cached->second;
+    bool res = false;
+    switch (expr->get_type()) {
+      case ir::IRNodeType::Const:
+        res = true;
+        break;
+      case ir::IRNodeType::IterVar: {
+        auto &name = ir::ptr_cast<ir::IterVar>(expr)->get_name();
+        res = name != name_ && !declared_.count(name);
+        break;
+      }
+      case ir::IRNodeType::ScalarVar: {
+        auto var = ir::ptr_cast<ir::ScalarVar>(expr);
+        res = var->is_placeholder() && !declared_.count(var->get_name());
+        break;
+      }
+      case ir::IRNodeType::Binary: {
+        auto binary = ir::ptr_cast<ir::Binary>(expr);
+        res = invariant(binary->lhs) && invariant(binary->rhs);
+        break;
+      }
+      case ir::IRNodeType::Logical: {
+        auto logical = ir::ptr_cast<ir::Logical>(expr);
+        res = invariant(logical->lhs) && invariant(logical->rhs);
+        break;
+      }
+      case ir::IRNodeType::Unary:
+        res = invariant(ir::ptr_cast<ir::Unary>(expr)->operand);
+        break;
+      case ir::IRNodeType::Cast:
+        res = invariant(ir::ptr_cast<ir::Cast>(expr)->expr_);
+        break;
+      case ir::IRNodeType::Select: {
+        auto select = ir::ptr_cast<ir::Select>(expr);
+        res = invariant(select->cond) && invariant(select->tBranch) &&
+              invariant(select->fBranch);
+        break;
+      }
+      default:
+        break;
+    }
+    invariant_[expr.get()] = res;
+    return res;
+  }
+
+  /// nullptr when 'expr' is invariant, clears '*affine' when it is not a sum
+  /// of products of the loop variable and invariants of its type (the C
+  /// promotions would otherwise change the arithmetic).
+  ir::ExprPtr coefficient(const ir::ExprPtr &expr, bool *affine) {
+    if (literal(expr)) return nullptr;
+    if (expr->get_dtype() != dtype_) {
+      *affine = false;
+      return nullptr;
+    }
+    if (invariant(expr)) return nullptr;
+    if (expr->get_type() == ir::IRNodeType::IterVar &&
+        ir::ptr_cast<ir::IterVar>(expr)->get_name() == name_) {
+      return makeConst(1, dtype_);
+    }
+    if (expr->get_type() != ir::IRNodeType::Binary) {
+      *affine = false;
+      return nullptr;
+    }
+    auto binary = ir::ptr_cast<ir::Binary>(expr);
+    auto op = binary->operation_type;
+    if (op != ir::BinaryType::Add && op != ir::BinaryType::Sub &&
+        op != ir::BinaryType::Mul) {
+      *affine = false;
+      return nullptr;
+    }
+    auto lhs = coefficient(binary->lhs, affine);
+    auto rhs = coefficient(binary->rhs, affine);
+    if (!*affine) return nullptr;
+    if (op == ir::BinaryType::Mul) {
+      if (lhs && rhs) {
+        *affine = false;
+        return nullptr;
+      }
+      return lhs ? fold(op, lhs, binary->rhs) : fold(op, binary->lhs, rhs);
+    }
+    if (!rhs) return lhs;
+    if (!lhs) lhs = makeConst(0, dtype_);
+    return fold(op, lhs, rhs);
+  }
+
+  /// Constants print as literals, which C promotes to the loop type as long
+  /// as they fit an int, whatever their type in the IR.
+  static bool literal(const ir::ExprPtr &expr) {
+    uint64_t value;
+    if (readUnsigned(expr, &value)) return value <= INT32_MAX;
+    if (expr->get_type() != ir::IRNodeType::Binary) return false;
+    auto binary = ir::ptr_cast<ir::Binary>(expr);
+    auto op = binary->operation_type;
+    return (op == ir::BinaryType::Add || op == ir::BinaryType::Sub ||
+            op == ir::BinaryType::Mul) &&
+           literal(binary->lhs) && literal(binary->rhs);
+  }
+
+  static bool multiplies(const ir::ExprPtr &expr) {
+    if (expr->get_type() == ir::IRNodeType::Cast) {
+      return multiplies(ir::ptr_cast<ir::Cast>(expr)->expr_);
+    }
+    if (expr->get_type() != ir::IRNodeType::Binary) return false;
+    auto binary = ir::ptr_cast<ir::Binary>(expr);
+    return binary->operation_type == ir::BinaryType::Mul ||
+           multiplies(binary->lhs) || multiplies(binary->rhs);
+  }
+
+  std::string name_;
+  ir::ScalarType dtype_;
+  const std::unordered_set<std::string> &declared_;
+  std::unordered_map<const ir::Node *, bool> invariant_;
+};
+}  // namespace
+
+ir::NodePtr DivModReducer::visit(ir::Binary *node) {
+  mutate(node->lhs);
+  mutate(node->rhs);
+  auto dtype = node->get_dtype();
+  bool is_div = node->operation_type == ir::BinaryType::Div;
+  uint64_t d;
+  if ((!is_div && node->operation_type != ir::BinaryType::Mod) ||
+      (dtype != ir::ScalarType::UInt32 && dtype != ir::ScalarType::UInt64) ||
+      !readUnsigned(node->rhs, &d) || d == 0) {
+    return node->shared_from_this();
+  }
+  int bits = dtype == ir::ScalarType::UInt32 ? 32 : 64;
+  if (bits == 32 && d >> 32) return node->shared_from_this();
+  auto x = node->lhs;
+
+  if ((d & (d - 1)) == 0) {
+    int k = 0;
+    while ((uint64_t(1) << k) < d) ++k;
+    if (is_div) return shiftRight(x, k);
+    return std::make_shared<ir::Binary>(x, makeConst(d - 1, dtype),
+                                        ir::BinaryType::And);
+  }
+
+  auto magic = unsignedMagic(d, bits);
+  auto args = std::make_shared<ir::Array<ir::Expr>>();
+  args->element.push_back(x);
+  args->element.push_back(
+      std::make_shared<Const<uint64_t>>(magic.m, ir::ScalarType::UInt64));
+  ExprPtr q = std::make_shared<ir::Call>(ir::CallFunction::mulhi, args, dtype);
+  if (magic.add) {
+    q = shiftRight(std::make_shared<ir::Binary>(x, q, ir::BinaryType::Sub), 1) +
+        q;
+  }
+  q = shiftRight(q, magic.shift);
+  if (is_div) return q;
+  return x - q * makeConst(d, dtype);
+}
+
+ir::NodePtr InductionVarReducer::visit(ir::For *node) {
+  mutate(node->body);
+  auto iter = node->it;
+  auto dtype = iter->get_dtype();
+  if ((node->for_type != ir::ForType::Serial &&
+       node->for_type != ir::ForType::Unrolled) ||
+      (iter->iter_type != ir::IterAttrType::Data &&
+       iter->iter_type != ir::IterAttrType::Unrolled) ||
+      (dtype != ir::ScalarType::UInt32 && dtype != ir::ScalarType::UInt64)) {
+    return node->shared_from_this();
+  }
+  auto candidates = [&](const ir::StmtPtr &body, AccessCollector *accesses) {
+    accesses->stmt(body);
+    Affine affine(iter, accesses->declared);
+    std::vector<std::pair<ir::ExprPtr *, ir::ExprPtr>> res;
+    for (auto slot : accesses->slots) {
+      auto stride = affine.stride(*slot);
+      if (stride) res.emplace_back(slot, stride);
+    }
+    return res;
+  };
+  AccessCollector probe(offsets_);
+  if (candidates(node->body, &probe).empty()) return node->shared_from_this();
+
+  // the body may be shared with other loops (e.g. the remainder of a
+  // partially unrolled loop).  Renaming the loop variable to a copy rebuilds
+  // exactly the nodes that depend on it, which can then be edited in place.
+  auto it = std::make_shared<ir::IterVar>(*iter);
+  auto body =
+      StmtCowSubstitute({{iter->get_name(), it}}).substitute(node->body);
+  AccessCollector accesses(offsets_);
+  // offset and initial value, the copies of an index share an offset.
+  std::vector<std::pair<ir::TensorVarPtr, ir::ExprPtr>> inits;
+  std::vector<ir::ExprPtr> indices;
+  // offsets are one-element arrays, the IR has no mutable scalars.
+  auto one = makeConst(1, ir::ScalarType::UInt64);
+  auto zero = std::make_shared<ir::Array<ir::Expr>>();
+  zero->element.push_back(makeConst(0, ir::ScalarType::UInt64));
+  for (auto &candidate : candidates(body, &accesses)) {
+    auto index = *candidate.first;
+    ir::TensorVarPtr offset;
+    for (size_t i = 0; i < indices.size() && !offset; ++i) {
+      if (indices[i] == index || ir::exprEqual(indices[i].get(), index.get())) {
+        offset = inits[i].first;
+      }
+    }
+    if (!offset) {
+      auto name = "offset" + std::to_string(offsets_.size());
+      offset = dtype == ir::ScalarType::UInt32
+                   ? api::placeholder<uint32_t>({one}, name)
+                   : api::placeholder<uint64_t>({one}, name);
+      offsets_.insert(offset.get());
+      auto init = StmtCowSubstitute({{iter->get_name(), node->init}})
+                      .substitute(index);
+      inits.emplace_back(offset, init);
+      indices.push_back(index);
+      ir::ExprPtr next = std::make_shared<ir::ScalarVar>(offset, zero);
+      next = std::make_shared<ir::Binary>(next, candidate.second,
+                                          ir::BinaryType::Add);
+      body = std::make_shared<ir::Block>(
+          body, std::make_shared<ir::Store>(offset, next, zero));
+    }
+    *candidate.first = std::make_shared<ir::ScalarVar>(offset, zero);
+  }
+
+  ir::StmtPtr res = std::make_shared<ir::For>(*node);
+  auto loop = ir::ptr_cast<ir::For>(res);
+  loop->it = it;
+  loop->body = body;
+  for (auto init = inits.rbegin(); init != inits.rend(); ++init) {
+    res = std::make_shared<ir::Block>(
+        std::make_shared<ir::Store>(init->first, init->second, zero), res);
+  }
+  for (auto init = inits.rbegin(); init != inits.rend(); ++init) {
+    auto bound = std::make_shared<ir::Array<ir::Range>>();
+    bound->element.push_back(
+        std::make_shared<ir::Range>(zero->element[0], one));
+    res = std::make_shared<ir::Allocate>(init->first, bound, res);
+  }
+  return res;
+}
+
+namespace api {
+ir::StmtPtr reduceDivMod(ir::StmtPtr stmt) {
+  DivModReducer reducer;
+  return ir::ptr_cast<ir::Stmt>(reducer.visit(stmt.get()));
+}
+
+ir::StmtPtr reduceInductionVars(ir::StmtPtr stmt) {
+  InductionVarReducer reducer;
+  return ir::ptr_cast<ir::Stmt>(reducer.visit(stmt.get()));
+}
+}  // namespace api
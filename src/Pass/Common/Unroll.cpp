@@ -1,12 +1,27 @@
 #include "Pass/Common/Unroll.h"
 
 #include "IR/Expr.h"
+#include "IR/VisitorBase.h"
 #include "api.h"
 
+namespace {
+/// Finds declarations, which cannot be repeated in the same scope.
+class DeclFinder : public VisitorBase<DeclFinder> {
+ public:
+  using VisitorBase::visit;
+  void visit(ir::Let *node) { found = true; }
+  void visit(ir::Allocate *node) { found = true; }
+
+  bool found{false};
+};
+}  // namespace
+
 ir::StmtPtr substituteExpr(
-    ir::StmtPtr stmt, std::unordered_map<std::string, ir::ExprPtr> value_map) {
-  if (value_map.size() == 0) return stmt;
-  return ir::ptr_cast<ir::Stmt>(IRSubstitue(value_map).visit(stmt.get()));
+    ir::StmtPtr stmt,
+    const std::unordered_map<std::string, ir::ExprPtr> &value_map) {
+  // copy-on-write: the unrolled bodies share every subtree that does not
+  // depend on the unrolled IterVar.
+  return StmtCowSubstitute(value_map).substitute(stmt);
 }
 
 void blockSplit(ir::StmtPtr stmt, std::vector<ir::StmtPtr> &blk_list) {
@@ -28,19 +43,23 @@ ir::NodePtr UnrollFuller::visit(ir::For *node) {
   mutate(node->body);
   auto iter = node->it;
   auto body = node->body;
-  auto init = ir::ptr_cast<Const<uint64_t>>(node->init);
-  auto extent = ir::ptr_cast<Const<uint64_t>>(node->extent);
-  auto init_ = static_cast<size_t>(init->get_value());
-  auto extent_ = static_cast<size_t>(extent->get_value());
-  if (iter->iter_type == ir::IterAttrType::Unrolled) {
+  // only loops with constant bounds can be fully unrolled.
+  auto isConstBound = [](const ir::ExprPtr &e) {
+    return e->get_type() == ir::IRNodeType::Const &&
+           e->get_dtype() == ir::ScalarType::UInt64;
+  };
+  if (iter->iter_type == ir::IterAttrType::Unrolled &&
+      isConstBound(node->init) && isConstBound(node->extent)) {
+    auto init = ir::ptr_cast<Const<uint64_t>>(node->init);
+    auto extent = ir::ptr_cast<Const<uint64_t>>(node->extent);
+    auto init_ = static_cast<size_t>(init->get_value());
+    auto extent_ = static_cast<size_t>(extent->get_value());
     std::unordered_map<std::string, ir::ExprPtr> value_map;
     std::vector<StmtPtr> blk_;
     for (size_t i = init_ + 1; i < extent_; i++) {
       value_map[iter->get_name()] =
           std::make_shared<Const<uint64_t>>(i, ir::ScalarType::UInt64);
-      StmtPtr blk = ir::ptr_cast<ir::Stmt>(stmt_copyer.stmt_copy(body));
-      blk = substituteExpr(blk, value_map);
-      blk_.push_back(blk);
+      blk_.push_back(substituteExpr(body, value_map));
     }
     value_map[iter->get_name()] =
         std::make_shared<Const<uint64_t>>(0, ir::ScalarType::UInt64);
@@ -85,6 +104,90 @@ ir::NodePtr UnrollFuller::visit(ir::For *node) {
   return node->shared_from_this();
 }
 
+ir::NodePtr PartialUnroller::visit(ir::For *node) {
+  mutate(node->body);
+  auto iter = node->it;
+  uint64_t factor = iter->unroll_factor;
+  if (iter->iter_type != ir::IterAttrType::Unrolled || factor < 2) {
+    return node->shared_from_this();
+  }
+  DeclFinder decl;
+  decl.visit(node->body.get());
+  if (decl.found) {
+    ELENA_WARN("Can not unroll " << iter->get_name()
+                                 << " by a factor, its body has declarations");
+    return node->shared_from_this();
+  }
+
+  auto dtype = iter->get_dtype();
+  std::unordered_map<std::string, ir::ExprPtr> value_map;
+  auto const_extent = ir::ptr_cast<Const<uint64_t>>(node->extent);
+  // short loops are unrolled completely, iteration 'k' is 'init + k'.
+  if (const_extent && const_extent->get_value() > 0 &&
+      const_extent->get_value() <= factor) {
+    auto const_init = ir::ptr_cast<Const<uint64_t>>(node->init);
+    StmtPtr body;
+    for (uint64_t k = 0; k < const_extent->get_value(); ++k) {
+      if (const_init) {
+        value_map[iter->get_name()] = std::make_shared<Const<uint64_t>>(
+            const_init->get_value() + k, dtype);
+      } else {
+        value_map[iter->get_name()] = std::make_shared<ir::Binary>(
+            node->init, std::make_shared<Const<uint64_t>>(k, dtype),
+            ir::BinaryType::Add);
+      }
+      auto copy = substituteExpr(node->body, value_map);
+      body = body ? std::make_shared<ir::Block>(body, copy) : copy;
+    }
+    return body;
+  }
+
+  ExprPtr n = std::make_shared<Const<uint64_t>>(factor, dtype);
+  ExprPtr zero = std::make_shared<Const<uint64_t>>(0, dtype);
+  ExprPtr main_extent, unrolled, rest;
+  if (const_extent) {
+    uint64_t extent = const_extent->get_value();
+    main_extent = std::make_shared<Const<uint64_t>>(extent / factor, dtype);
+    unrolled =
+        std::make_shared<Const<uint64_t>>(extent / factor * factor, dtype);
+    rest = std::make_shared<Const<uint64_t>>(extent % factor, dtype);
+  } else {
+    main_extent =
+        std::make_shared<ir::Binary>(node->extent, n, ir::BinaryType::Div);
+    unrolled =
+        std::make_shared<ir::Binary>(main_extent, n, ir::BinaryType::Mul);
+    rest = std::make_shared<ir::Binary>(node->extent, unrolled,
+                                        ir::BinaryType::Sub);
+  }
+
+  // iteration 'init + outer * factor + k' for k in [0, factor).
+  auto outer = std::make_shared<ir::IterVar>(
+      std::make_shared<ir::Range>(zero, main_extent),
+      iter->get_name() + ".unroll", iter->is_reduce);
+  ExprPtr base = std::make_shared<ir::Binary>(
+      node->init, std::make_shared<ir::Binary>(outer, n, ir::BinaryType::Mul),
+      ir::BinaryType::Add);
+  StmtPtr body;
+  for (uint64_t k = 0; k < factor; ++k) {
+    value_map[iter->get_name()] = std::make_shared<ir::Binary>(
+        base, std::make_shared<Const<uint64_t>>(k, dtype),
+        ir::BinaryType::Add);
+    auto copy = substituteExpr(node->body, value_map);
+    body = body ? std::make_shared<ir::Block>(body, copy) : copy;
+  }
+  StmtPtr main = std::make_shared<ir::For>(outer, zero, main_extent, body);
+  if (const_extent && const_extent->get_value() % factor == 0) return main;
+
+  // the remainder keeps the original loop variable and body, as a plain
+  // loop: it runs fewer than 'factor' iterations, usually a symbolic
+  // count, and must not be printed with an unroll pragma.
+  iter->iter_type = ir::IterAttrType::Data;
+  auto tail_init =
+      std::make_shared<ir::Binary>(node->init, unrolled, ir::BinaryType::Add);
+  StmtPtr tail = std::make_shared<ir::For>(iter, tail_init, rest, node->body);
+  return std::make_shared<ir::Block>(main, tail);
+}
+
 ir::NodePtr AutoUnroller::visit(ir::For *node) {
   mutate(node->body);
   if (is_unroll) {
@@ -112,6 +215,12 @@ StmtPtr unrollFull(StmtPtr stmt) {
   return stmt;
 }
 
+StmtPtr unrollPartial(StmtPtr stmt) {
+  PartialUnroller unroller;
+  stmt = ir::ptr_cast<ir::Stmt>(unroller.visit(stmt.get()));
+  return stmt;
+}
+
 StmtPtr autoUnroll(StmtPtr stmt, bool is_full_unroll) {
   AutoUnroller unroller(is_full_unroll);
   stmt = ir::ptr_cast<ir::Stmt>(unroller.visit(stmt.get()));
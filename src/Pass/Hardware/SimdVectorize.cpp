@@ -4,204 +4,439 @@
 
 #include "Pass/Hardware/SimdVectorize.h"
 
-#include <utility>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
-#include "IR/Type.h"
+#include "Pass/Common/StmtCopy.h"
 #include "api.h"
-#include "x/ir_node_types.def"
-
-namespace ir {
-
-// 1. Set symbol type for var (the left of equal sign) and value (the right of
-// equal sign).
-// 2. Substitute the current 'iter var' to 0.
-// 3. Set lanes.
-// PS: except for the 'Binary', 'Unary' and 'Logical' Node.
-StmtPtr Vectorizer::visit(Store* op) {
-  mutate(op->value);
-  SymbolType value_symbol_type = Scalar_Symbol;
-  if (op->value->get_type() == IRNodeType::ScalarVar) {
-    ScalarVarPtr sv_value = ptr_cast<ScalarVar>(op->value);
-    // remove iter and set symbol type
-    if (sv_value->tensor && sv_value->indices) {
-      for (int i = 0; i < sv_value->indices->size(); i++) {
-        auto& ele = sv_value->indices->element[i];
-        if (ele->get_type() == IRNodeType::IterVar && ele == loop_var_) {
-          ele = std::make_shared<Const<uint64_t>>(0, ele->get_dtype());
-          value_symbol_type = Vecotr_Symbol;
+#include "logging.h"
+
+namespace {
+bool readInteger(const ir::ExprPtr &expr, int64_t *value) {
+  if (expr->get_type() != ir::IRNodeType::Const) return false;
+  switch (expr->get_dtype()) {
+#define TYPE_MAP_NATIVE_TO_SCALARTYPE(native_type, scalar_type)          \
+  case ir::ScalarType::scalar_type:                                      \
+    *value = static_cast<int64_t>(                                       \
+        static_cast<Const<native_type> *>(expr.get())->get_value());     \
+    return true;
+#define TYPE_MAP_FLOAT(native_type, scalar_type)
+#define TYPE_MAP_BOOL(native_type, scalar_type)
+#include "x/scalar_types.def"
+    default:
+      return false;
+  }
+}
+
+bool wideInteger(ir::ScalarType dtype) {
+  return dtype == ir::ScalarType::Int32 || dtype == ir::ScalarType::UInt32 ||
+         dtype == ir::ScalarType::Int64 || dtype == ir::ScalarType::UInt64;
+}
+
+/// Whether lanes of 'dtype' load without widening shuffles.
+bool wide(ir::ScalarType dtype) {
+  return wideInteger(dtype) || dtype == ir::ScalarType::Float32 ||
+         dtype == ir::ScalarType::Float64;
+}
+
+/// How the expressions of a loop body vary with its loop variable.
+class Lanes {
+ public:
+  explicit Lanes(const std::string &name) : name_(name) {}
+
+  /// Whether 'expr' reads the loop variable.
+  bool depends(const ir::ExprPtr &expr) {
+    auto cached = depends_.find(expr.get());
+    if (cached != depends_.end()) return cached->second;
+    bool res = true;
+    switch (expr->get_type()) {
+      case ir::IRNodeType::Const:
+        res = false;
+        break;
+      case ir::IRNodeType::IterVar:
+        res = ir::ptr_cast<ir::IterVar>(expr)->get_name() == name_;
+        break;
+      case ir::IRNodeType::ScalarVar: {
+        auto var = ir::ptr_cast<ir::ScalarVar>(expr);
+        res = false;
+        if (var->is_placeholder()) break;
+        for (auto &index : var->indices->element) res |= depends(index);
+        break;
+      }
+      case ir::IRNodeType::Binary: {
+        auto binary = ir::ptr_cast<ir::Binary>(expr);
+        res = depends(binary->lhs) || depends(binary->rhs);
+        break;
+      }
+      case ir::IRNodeType::Logical: {
+        auto logical = ir::ptr_cast<ir::Logical>(expr);
+        res = depends(logical->lhs) || depends(logical->rhs);
+        break;
+      }
+      case ir::IRNodeType::Unary:
+        res = depends(ir::ptr_cast<ir::Unary>(expr)->operand);
+        break;
+      case ir::IRNodeType::Cast:
+        res = depends(ir::ptr_cast<ir::Cast>(expr)->expr_);
+        break;
+      case ir::IRNodeType::Select: {
+        auto select = ir::ptr_cast<ir::Select>(expr);
+        res = depends(select->cond) || depends(select->tBranch) ||
+              depends(select->fBranch);
+        break;
+      }
+      case ir::IRNodeType::Call: {
+        res = false;
+        for (auto &arg : ir::ptr_cast<ir::Call>(expr)->args->element) {
+          res |= depends(arg);
         }
+        break;
       }
+      default:
+        break;
     }
+    depends_[expr.get()] = res;
+    return res;
   }
-  mutate(op->var);
-  bool need_vectorize_var = false;
-  for (int i = 0; i < op->index->size(); i++) {
-    auto& ele = op->index->element[i];
-    if (ele->get_type() == IRNodeType::IterVar && ele == loop_var_) {
-      ele = std::make_shared<Const<uint64_t>>(0, ele->get_dtype());
-      need_vectorize_var = true;
+
+  /// Whether 'index' is affine in the loop variable with a constant stride,
+  /// written to '*stride' (0 when it does not depend on it).  The stride is
+  /// the difference of the indices of consecutive iterations, so it is
+  /// reduced to the width of the index.
+  bool stride(const ir::ExprPtr &index, int64_t *stride) {
+    if (!coefficient(index, stride)) return false;
+    if (index->get_dtype() == ir::ScalarType::Int32 ||
+        index->get_dtype() == ir::ScalarType::UInt32) {
+      *stride = static_cast<int32_t>(*stride);
     }
+    return true;
   }
-  SymbolType var_symbol_type =
-      need_vectorize_var ? Vecotr_Symbol : Broadcast_Symbol;
-  // todo: Test if there's a bug in such condition:
-  //  for (int i = 0; i < n1; i++) {
-  //    for (int j = 0; j < n2; j++) {
-  //      c[i * n2 +j] = a[i] + b[j];
-  //    }
-  //  }
-  // which need to transform into:
-  // VS(VS(c[0, 1, n1*n2])) =
-  // VS(BS(a[0, 1, n2), 1, n1) + BS(VS(b[0, 1, n2], 1, n1))
-  return std::make_shared<Store>(
-      ptr_cast<Var>(setLanes(op->var, var_symbol_type)),
-      setLanes(op->value, value_symbol_type), op->index);
-}
 
-StmtPtr Vectorizer::visit(IfThenElse* op) {
-  // todo: concern when the condition is vector or broadcast
-  return ptr_cast<Stmt>(MutatorBase::visit(op->then_case.get()));
-}
-StmtPtr Vectorizer::visit(Let* op) {
-  return ptr_cast<Stmt>(MutatorBase::visit(op->body.get()));
-}
-StmtPtr Vectorizer::visit(Allocate* op) {
-  return ptr_cast<Stmt>(MutatorBase::visit(op->body.get()));
-}
-ExprPtr Vectorizer::visit(Call* op) {
-  return ptr_cast<Expr>(MutatorBase::visit(op));
-}
-ExprPtr Vectorizer::visit(Cast* op) {
-  return ptr_cast<Expr>(MutatorBase::visit(op));
-}
-ExprPtr Vectorizer::visit(Unary* op) {
-  return ptr_cast<Expr>(MutatorBase::visit(op));
-}
+ private:
+  bool coefficient(const ir::ExprPtr &expr, int64_t *res) {
+    *res = 0;
+    if (!depends(expr)) return true;
+    if (!wideInteger(expr->get_dtype())) return false;
+    switch (expr->get_type()) {
+      case ir::IRNodeType::IterVar:
+        *res = 1;
+        return true;
+      case ir::IRNodeType::Cast:
+        // the widths are at least 32 bits, the cast keeps the residue.
+        return wideInteger(ir::ptr_cast<ir::Cast>(expr)->expr_->get_dtype()) &&
+               coefficient(ir::ptr_cast<ir::Cast>(expr)->expr_, res);
+      case ir::IRNodeType::Binary: {
+        auto binary = ir::ptr_cast<ir::Binary>(expr);
+        int64_t lhs, rhs;
+        switch (binary->operation_type) {
+          case ir::BinaryType::Add:
+          case ir::BinaryType::Sub:
+            if (!coefficient(binary->lhs, &lhs) ||
+                !coefficient(binary->rhs, &rhs)) {
+              return false;
+            }
+            *res = binary->operation_type == ir::BinaryType::Add ? lhs + rhs
+                                                                 : lhs - rhs;
+            return true;
+          case ir::BinaryType::Mul: {
+            int64_t factor;
+            if (readInteger(binary->lhs, &factor)) {
+              if (!coefficient(binary->rhs, &rhs)) return false;
+            } else if (readInteger(binary->rhs, &factor)) {
+              if (!coefficient(binary->lhs, &rhs)) return false;
+            } else {
+              return false;
+            }
+            *res = factor * rhs;
+            return true;
+          }
+          default:
+            return false;
+        }
+      }
+      default:
+        return false;
+    }
+  }
+
+  std::string name_;
+  std::unordered_map<const ir::Node *, bool> depends_;
+};
+
+/// Whether the iterations of a loop body are independent, see
+/// LoopVectorizer.
+class LaneScan {
+ public:
+  explicit LaneScan(Lanes *lanes) : lanes_(lanes) {}
+
+  bool scan(const ir::StmtPtr &body) {
+    if (!stmt(body)) return false;
+    for (auto tensor : stored_) {
+      if (loaded_.count(tensor)) return false;
+    }
+    return true;
+  }
+
+ private:
+  bool stmt(const ir::StmtPtr &node) {
+    if (!node) return true;
+    switch (node->get_type()) {
+      case ir::IRNodeType::Block: {
+        auto block = ir::ptr_cast<ir::Block>(node);
+        return stmt(block->head) && stmt(block->tail);
+      }
+      case ir::IRNodeType::IfThenElse: {
+        auto branch = ir::ptr_cast<ir::IfThenElse>(node);
+        if (!expr(branch->condition)) return false;
+        Guard guard(this, branch->condition);
+        return stmt(branch->then_case) && stmt(branch->else_case);
+      }
+      case ir::IRNodeType::Store: {
+        auto store = ir::ptr_cast<ir::Store>(node);
+        stored_.insert(store->var.get());
+        // every iteration writes its own element.
+        bool distinct = false;
+        for (auto &index : store->index->element) {
+          int64_t stride;
+          if (!lanes_->stride(index, &stride)) return false;
+          distinct |= stride != 0;
+          if (!expr(index)) return false;
+        }
+        return distinct && expr(store->value);
+      }
+      default:
+        // nested loops, declarations and calls for their side effects.
+        return false;
+    }
+  }
 
-// 1. Set symbol type for lhs and rhs.
-// 2. Substitute the current 'iter var' to 0.
-// 3. Set lanes by 'SetLanes' in 'VectorizeBinary'.
-ExprPtr Vectorizer::visit(Binary* op) {
-  VarPtr lhs_var = ptr_cast<Var>(op->lhs);
-  VarPtr rhs_var = ptr_cast<Var>(op->rhs);
-  auto modify_iter = [&](const VarPtr& var) {
-    if (var->get_type() == IRNodeType::ScalarVar) {
-      ScalarVarPtr sv_var = ptr_cast<ScalarVar>(var);
-      if ((sv_var->tensor != nullptr) && (sv_var->indices != nullptr)) {
-        size_t iter_index = sv_var->indices->findvar(loop_var_);
-        if (iter_index != sv_var->indices->size()) {
-          sv_var->indices->element[iter_index] =
-              std::make_shared<Const<uint64_t>>(
-                  0, sv_var->indices->element[iter_index]->get_dtype());
-          return Vecotr_Symbol;
-        } else {
-          return Broadcast_Symbol;
+  bool expr(const ir::ExprPtr &node) {
+    if (!seen_.insert(node.get()).second) return true;
+    switch (node->get_type()) {
+      case ir::IRNodeType::ScalarVar: {
+        auto load = ir::ptr_cast<ir::ScalarVar>(node);
+        if (load->is_placeholder()) return true;
+        // lanes may not load what their iteration does not.
+        if (guarded_) return false;
+        loaded_.insert(load->tensor.get());
+        for (auto &index : load->indices->element) {
+          if (lanes_->depends(index) && !wide(load->get_dtype())) {
+            return false;
+          }
+          if (!expr(index)) return false;
+        }
+        return true;
+      }
+      case ir::IRNodeType::Binary: {
+        auto binary = ir::ptr_cast<ir::Binary>(node);
+        return expr(binary->lhs) && expr(binary->rhs);
+      }
+      case ir::IRNodeType::Logical: {
+        auto logical = ir::ptr_cast<ir::Logical>(node);
+        return expr(logical->lhs) && expr(logical->rhs);
+      }
+      case ir::IRNodeType::Unary:
+        return expr(ir::ptr_cast<ir::Unary>(node)->operand);
+      case ir::IRNodeType::Cast:
+        return expr(ir::ptr_cast<ir::Cast>(node)->expr_);
+      case ir::IRNodeType::Select: {
+        auto select = ir::ptr_cast<ir::Select>(node);
+        if (!expr(select->cond)) return false;
+        Guard guard(this, select->cond);
+        return expr(select->tBranch) && expr(select->fBranch);
+      }
+      case ir::IRNodeType::Call: {
+        // the helpers binding an iterator loop over the source themselves.
+        auto call = ir::ptr_cast<ir::Call>(node);
+        for (size_t i = 0; i < call->args->element.size(); ++i) {
+          if (call->arg_type(i) != ir::CallArgType::Value ||
+              !expr(call->args->element[i])) {
+            return false;
+          }
         }
+        return true;
       }
+      case ir::IRNodeType::Const:
+      case ir::IRNodeType::IterVar:
+        return true;
+      default:
+        return false;
     }
-    ELENA_ABORT("Should never be here");
+  }
+
+  /// Counts the conditions depending on the loop variable around a scope.
+  class Guard {
+   public:
+    Guard(LaneScan *scan, const ir::ExprPtr &cond)
+        : scan_(scan), lanes_(scan->lanes_->depends(cond)) {
+      scan_->guarded_ += lanes_;
+    }
+    ~Guard() { scan_->guarded_ -= lanes_; }
+
+   private:
+    LaneScan *scan_;
+    int lanes_;
   };
-  SymbolType lhs_symbol_type = modify_iter(lhs_var);
-  SymbolType rhs_symbol_type = modify_iter(rhs_var);
-  std::unordered_map<BinaryType, std::function<ExprPtr(ExprPtr, ExprPtr)>,
-                     BinaryTypeHash>
-      binary_func = {
-          {BinaryType::Add,
-           [](ExprPtr a, ExprPtr b) { return std::move(a) + std::move(b); }},
-          {BinaryType::Sub,
-           [](ExprPtr a, ExprPtr b) { return std::move(a) - std::move(b); }},
-      };
-  auto func_iter = binary_func.find(op->operation_type);
-  if (func_iter != binary_func.end()) {
-    return vectorizeBinary(op, func_iter->second, lhs_symbol_type,
-                           rhs_symbol_type);
-  } else {
-    ELENA_ASSERT(false, "Do not support such binary operation currently!");
+
+  Lanes *lanes_;
+  int guarded_{0};
+  std::unordered_set<const ir::Node *> stored_, loaded_, seen_;
+};
+
+/// Rewrites a loop body for the lane 'lane' of a loop starting at 'init',
+/// in place: the body must not share the nodes depending on the loop
+/// variable.
+class LaneRewriter : public MutatorBase<LaneRewriter> {
+ public:
+  LaneRewriter(Lanes *lanes, const ir::IterVarPtr &it, const ir::ExprPtr &init,
+               const ir::IterVarPtr &lane)
+      : lanes_(lanes), name_(it->get_name()), init_(init), lane_(lane) {
+    value_ = std::make_shared<ir::Cast>(lane, it->get_dtype());
+    int64_t first;
+    if (!readInteger(init, &first) || first != 0) {
+      value_ = std::make_shared<ir::Binary>(init, value_, ir::BinaryType::Add);
+    }
   }
-}
 
-ExprPtr Vectorizer::visit(Logical* op) {
-  return ptr_cast<Expr>(MutatorBase::visit(op));
-}
+  using MutatorBase::visit;
+  ir::NodePtr visit(ir::IterVar *node) {
+    if (node->get_name() == name_) return value_;
+    return node->shared_from_this();
+  }
 
-// Set lanes for Binary expr the return as vectorized binary expr.
-template <typename T, typename FCompute>
-ExprPtr Vectorizer::vectorizeBinary(const T* op, FCompute fcompute,
-                                    SymbolType lhs_symbol_type,
-                                    SymbolType rhs_symbol_type) {
-  this->visit(op->lhs.get());
-  this->visit(op->rhs.get());
-  return fcompute(setLanes(op->lhs, lhs_symbol_type),
-                  setLanes(op->rhs, rhs_symbol_type));
-}
+  ir::NodePtr visit(ir::ScalarVar *node) {
+    if (!node->is_placeholder() && rewritten_.insert(node).second) {
+      rewrite(node->indices);
+    }
+    return node->shared_from_this();
+  }
 
-// Set lanes based on the previous lanes.
-ExprPtr Vectorizer::setLanes(ExprPtr e, SymbolType symbol_type) const {
-  uint64_t new_lanes = var_lanes_;
-  VarPtr current_var = ptr_cast<Var>(e);
-  std::stack<SymbolType> current_symbol_stack;
-  if (e->get_type() == IRNodeType::VectorSymbol) {
-    VectorSymbolPtr vs_ptr = ptr_cast<VectorSymbol>(e);
-    new_lanes *= vs_ptr->get_lanes();
-    current_symbol_stack = vs_ptr->get_current_symbol_stack();
-  } else if (e->get_type() == IRNodeType::BroadcastSymbol) {
-    BroadcastSymbolPtr bs_ptr = ptr_cast<BroadcastSymbol>(e);
-    new_lanes *= bs_ptr->get_lanes();
-    current_symbol_stack = bs_ptr->get_current_symbol_stack();
-  }
-  switch (symbol_type) {
-    case Vecotr_Symbol:
-      current_symbol_stack.emplace(Vecotr_Symbol);
-      return std::make_shared<VectorSymbol>(e, current_symbol_stack, 1,
-                                            new_lanes);
-    case Broadcast_Symbol:
-      current_symbol_stack.emplace(Broadcast_Symbol);
-      return std::make_shared<BroadcastSymbol>(e, current_symbol_stack,
-                                               new_lanes);
-    case Scalar_Symbol:
-      return e;
-    default:
-      ELENA_ASSERT(false, "No such symbol type!");
+  ir::NodePtr visit(ir::Store *node) {
+    rewrite(node->index);
+    mutate(node->value);
+    return node->shared_from_this();
+  }
+
+  // tensors are shared with the schedule, leave their ops alone.
+  ir::NodePtr visit(ir::TensorVar *node) { return node->shared_from_this(); }
+
+ private:
+  void rewrite(const ir::ArrayPtr<ir::Expr> &indices) {
+    for (auto &index : indices->element) {
+      if (!lanes_->depends(index)) continue;
+      int64_t stride;
+      if (!lanes_->stride(index, &stride)) {
+        mutate(index);
+        continue;
+      }
+      // the channel 'c' of an interleaved access, 'c + s * x' with 'c < s',
+      // is added after the cast, which keeps the channels of a pixel one
+      // group of consecutive elements for the compiler.
+      int64_t offset = 0;
+      ir::ExprPtr rest = split(index, &offset);
+      if (offset <= 0 || offset >= (stride < 0 ? -stride : stride)) {
+        rest = index;
+        offset = 0;
+      }
+      ir::ExprPtr base = StmtCowSubstitute({{name_, init_}}).substitute(rest);
+      // the first lane may be outside of a pad guard, its index wrapped.
+      if (base->get_dtype() == ir::ScalarType::UInt32) {
+        base = std::make_shared<ir::Cast>(base, ir::ScalarType::Int32);
+      }
+      base = std::make_shared<ir::Cast>(base, ir::ScalarType::Int64);
+      if (offset) {
+        base = std::make_shared<ir::Binary>(
+            base,
+            std::make_shared<Const<int64_t>>(offset, ir::ScalarType::Int64),
+            ir::BinaryType::Add);
+      }
+      ir::ExprPtr step = lane_;
+      if (stride != 1) {
+        step = std::make_shared<ir::Binary>(
+            std::make_shared<Const<int64_t>>(stride, ir::ScalarType::Int64),
+            step, ir::BinaryType::Mul);
+      }
+      // 'lanes_' caches by address, the old index must outlive the rewrite.
+      replaced_.push_back(index);
+      index = std::make_shared<ir::Binary>(base, step, ir::BinaryType::Add);
+    }
   }
-}
 
-// Decide whether vectorize or not.
-StmtPtr LoopVectorizer::visit(For* op) {
-  mutate(op->body);
-  // todo: remove debug message
-  op->for_type = ForType::Vectorized;
-  if (op->for_type == ForType::Vectorized) {
-    auto init_const_ptr = ptr_cast<Const<uint64_t>>(op->init);
-    auto extent_const_ptr = ptr_cast<Const<uint64_t>>(op->extent);
-    if (init_const_ptr == nullptr || extent_const_ptr == nullptr) {
-      // todo: support dynamic shape
-      ELENA_LOG_INFO("Do not support dynamic shape currently!");
-      return ptr_cast<Stmt>(MutatorBase::visit(op->body.get()));
+  /// 'expr' without the constants of its sum, added to '*offset'.
+  ir::ExprPtr split(const ir::ExprPtr &expr, int64_t *offset) {
+    int64_t value;
+    if (readInteger(expr, &value)) {
+      *offset += value;
+      return nullptr;
     }
-    uint64_t init_value = init_const_ptr->get_value();
-    uint64_t extent_value = extent_const_ptr->get_value();
-
-    ELENA_ASSERT(init_value == 0, "The init value of the for op must be 0!");
-    ELENA_ASSERT(
-        extent_value >= 1,
-        "The extent_const_ptr of the for op must larger than or equal to 1 "
-        "when vectorization!");
-    Vectorizer(op->it, extent_value).mutate(op->body);
-    return op->body;
-  } else {
-    return std::make_shared<For>(op->it, op->init, op->extent, op->for_type,
-                                 op->body);
+    auto binary = ir::ptr_cast<ir::Binary>(expr);
+    if (!binary || binary->operation_type != ir::BinaryType::Add) return expr;
+    auto lhs = split(binary->lhs, offset), rhs = split(binary->rhs, offset);
+    if (!lhs || !rhs) return lhs ? lhs : rhs;
+    if (lhs == binary->lhs && rhs == binary->rhs) return expr;
+    return std::make_shared<ir::Binary>(lhs, rhs, ir::BinaryType::Add);
   }
+
+  Lanes *lanes_;
+  std::string name_;
+  ir::ExprPtr init_;
+  ir::IterVarPtr lane_;
+  ir::ExprPtr value_;
+  std::unordered_set<const ir::Node *> rewritten_;
+  std::vector<ir::ExprPtr> replaced_;
+};
+
+/// The lane loop running the iterations 'init' to 'init + extent' of 'node'.
+ir::StmtPtr laneLoop(ir::For *node, const ir::ExprPtr &init,
+                     const ir::ExprPtr &extent, Lanes *lanes) {
+  auto iter = node->it;
+  // the body may be shared with other loops, renaming the loop variable to
+  // a copy rebuilds the nodes the rewrite edits.
+  auto it = std::make_shared<ir::IterVar>(*iter);
+  auto body =
+      StmtCowSubstitute({{iter->get_name(), it}}).substitute(node->body);
+  auto zero = std::make_shared<Const<int64_t>>(0, ir::ScalarType::Int64);
+  auto lane =
+      std::make_shared<ir::IterVar>(iter->range, iter->get_name() + ".lane");
+  lane->set_dtype(ir::ScalarType::Int64);
+  LaneRewriter(lanes, it, init, lane).mutate(body);
+  return std::make_shared<ir::For>(lane, zero, extent, ir::ForType::Vectorized,
+                                   body);
 }
+}  // namespace
 
-StmtPtr LoopVectorizerSkipper::visit(For* op) {
-  ELENA_ASSERT(op != nullptr, "It's not a for stmt!");
-  if (op->for_type == ForType::Vectorized) {
-    return std::make_shared<For>(op->it, op->init, op->extent, op->for_type,
-                                 op->body);
-  } else {
-    return ptr_cast<Stmt>(MutatorBase::visit(op->body.get()));
+ir::NodePtr LoopVectorizer::visit(ir::For *node) {
+  mutate(node->body);
+  auto iter = node->it;
+  auto dtype = iter->get_dtype();
+  if (node->for_type != ir::ForType::Serial ||
+      iter->iter_type != ir::IterAttrType::Data ||
+      (dtype != ir::ScalarType::UInt32 && dtype != ir::ScalarType::UInt64)) {
+    return node->shared_from_this();
+  }
+  int64_t extent;
+  if (readInteger(node->extent, &extent) && extent < 2) {
+    return node->shared_from_this();
   }
+  Lanes lanes(iter->get_name());
+  if (!LaneScan(&lanes).scan(node->body)) return node->shared_from_this();
+  return laneLoop(node, node->init, node->extent, &lanes);
 }
 
-}  // namespace ir
+ir::NodePtr LoopVectorizer::visit(ir::Attr *node) {
+  // device kernels run their lanes on threads.
+  if (node->key == ir::AttrType::ThreadExtent) {
+    return node->shared_from_this();
+  }
+  return MutatorBase::visit(node);
+}
+
+namespace api {
+ir::StmtPtr vectorizeLoops(ir::StmtPtr stmt) {
+  LoopVectorizer vectorizer;
+  return ir::ptr_cast<ir::Stmt>(vectorizer.visit(stmt.get()));
+}
+}  // namespace api
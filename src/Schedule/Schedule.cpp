@@ -472,6 +472,7 @@ void RebaseNonZeroMinLoop(const SchedulePtr& sch) {
           s->iter_attr->element[rebased] = s->iter_attr->element.at(i);
         }
         rebased->iter_type = i->iter_type;
+        rebased->unroll_factor = i->unroll_factor;
         s->leaf_itervars->element[pos] = rebased;
         rebase_map[i] = rebased;
       }
@@ -514,6 +515,10 @@ void InjectInline(SchedulePtr sch) {
                 std::back_inserter(args->element));
       for (size_t j = i; j < sch->stages->element.size(); ++j) {
         StagePtr s = sch->stages->element[j];
+        // A later inlined stage has already been substituted into its
+        // consumers, so its own fcompute is dead; expanding it again only
+        // grows the schedule.
+        if (s->attach_type == AttachType::InlinedAlready) continue;
         if (s->op->get_type() == IRNodeType::ComputeOp) {
           const ComputeOpPtr copj = ir::ptr_cast<ComputeOp>(s->op);
           new_fcompute[j] = copj->fcompute;
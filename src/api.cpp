@@ -405,16 +405,6 @@ ir::StmtPtr rewriteStorage(ir::StmtPtr stmt) {
   return writer.rewrite(stmt);
 }
 
-ir::StmtPtr simdVectorizeLoop(ir::StmtPtr stmt, const bool enable_vectorize) {
-  ELENA_ASSERT(stmt != nullptr, "Stmt is not exit!");
-  if (enable_vectorize) {
-    ir::LoopVectorizer().mutate(stmt);
-  } else {
-    ir::LoopVectorizerSkipper().mutate(stmt);
-  }
-  return stmt;
-}
-
 // inject the operator's realization on the stmt.
 class InjectAttach : public MutatorBase<InjectAttach> {
  public: